@@ -3,12 +3,15 @@
 
 #include "qtzipreader.h"
 #include "qtzipwriter.h"
+#include <QtConcurrentMap>
 #include <QDateTime>
 #include <QDir>
 #include <QtDebug>
 #include <QtEndian>
 #include <QtGlobal>
+#include <QThread>
 
+#include <limits>
 #include <memory>
 
 #include <zlib.h>
@@ -122,7 +125,7 @@ static int inflate(Bytef *dest, ulong *destLen, const Bytef *source, ulong sourc
     return err;
 }
 
-static int deflate (Bytef *dest, ulong *destLen, const Bytef *source, ulong sourceLen)
+static int deflate (Bytef *dest, ulong *destLen, const Bytef *source, ulong sourceLen, int level)
 {
     z_stream stream;
     int err;
@@ -137,7 +140,7 @@ static int deflate (Bytef *dest, ulong *destLen, const Bytef *source, ulong sour
     stream.zfree = (free_func)nullptr;
     stream.opaque = (voidpf)nullptr;
 
-    err = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    err = deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
     if (err != Z_OK) return err;
 
     err = deflate(&stream, Z_FINISH);
@@ -151,6 +154,128 @@ static int deflate (Bytef *dest, ulong *destLen, const Bytef *source, ulong sour
     return err;
 }
 
+/*
+    Large files are compressed as independent chunks on multiple threads.
+    Every chunk but the last ends with a sync flush so that it finishes on a
+    byte boundary, which allows the chunks to be joined into a single valid
+    deflate stream. Each chunk is primed with the data preceding it so that
+    the compression ratio stays close to that of a single stream.
+*/
+enum {
+    ParallelDeflateChunkSize = 128 * 1024,
+    ParallelDeflateDictionarySize = 32 * 1024,
+    ParallelDeflateMinimumSize = 2 * ParallelDeflateChunkSize
+};
+
+struct DeflateChunk
+{
+    const Bytef *source;
+    uInt sourceLen;
+    const Bytef *dictionary;
+    uInt dictionaryLen;
+    int level;
+    bool last;
+    QByteArray compressed;
+    uLong crc;
+    int result;
+};
+
+static void deflateChunk(DeflateChunk &chunk)
+{
+    chunk.crc = ::crc32(::crc32(0, nullptr, 0), chunk.source, chunk.sourceLen);
+
+    z_stream stream;
+    stream.zalloc = (alloc_func)nullptr;
+    stream.zfree = (free_func)nullptr;
+    stream.opaque = (voidpf)nullptr;
+
+    chunk.result = deflateInit2(&stream, chunk.level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    if (chunk.result != Z_OK)
+        return;
+
+    if (chunk.dictionaryLen > 0)
+        deflateSetDictionary(&stream, chunk.dictionary, chunk.dictionaryLen);
+
+    // a sync flush adds an empty stored block after the compressed data
+    chunk.compressed.resize(deflateBound(&stream, chunk.sourceLen) + 16);
+    stream.next_in = const_cast<Bytef*>(chunk.source);
+    stream.avail_in = chunk.sourceLen;
+    stream.next_out = reinterpret_cast<Bytef*>(chunk.compressed.data());
+    stream.avail_out = uInt(chunk.compressed.size());
+
+    const int err = deflate(&stream, chunk.last ? Z_FINISH : Z_SYNC_FLUSH);
+    if (chunk.last ? (err == Z_STREAM_END) : (err == Z_OK && stream.avail_in == 0 && stream.avail_out > 0)) {
+        chunk.compressed.resize(stream.total_out);
+        chunk.result = Z_OK;
+    } else {
+        chunk.compressed.clear();
+        chunk.result = (err == Z_OK || err == Z_STREAM_END) ? Z_BUF_ERROR : err;
+    }
+
+    deflateEnd(&stream);
+}
+
+/*
+    Compresses \a source after its first \a dictionaryLen bytes, which are
+    only used to prime the compression, and appends it to \a dest. The CRC of
+    the compressed data is combined into \a crc. If \a last is set, the deflate
+    stream is finished; there is always at least one chunk so that an empty
+    final block can be written.
+*/
+static bool deflateChunks(QByteArray *dest, uLong *crc, const QByteArray &source, qsizetype dictionaryLen, bool last, int level)
+{
+    QList<DeflateChunk> chunks;
+    chunks.reserve((source.size() - dictionaryLen + ParallelDeflateChunkSize - 1) / ParallelDeflateChunkSize + 1);
+
+    const Bytef *data = reinterpret_cast<const Bytef*>(source.constData());
+    qsizetype start = dictionaryLen;
+    const qsizetype length = source.size();
+    do {
+        DeflateChunk chunk;
+        chunk.source = data + start;
+        chunk.sourceLen = uInt(qMin<qsizetype>(ParallelDeflateChunkSize, length - start));
+        chunk.dictionaryLen = uInt(qMin<qsizetype>(ParallelDeflateDictionarySize, start));
+        chunk.dictionary = chunk.source - chunk.dictionaryLen;
+        chunk.level = level;
+        chunk.last = last && ((start + chunk.sourceLen) >= length);
+        chunk.crc = 0;
+        chunk.result = Z_OK;
+        chunks.append(chunk);
+        start += chunk.sourceLen;
+    } while (start < length);
+
+    if (chunks.size() > 1)
+        QtConcurrent::blockingMap(chunks, deflateChunk);
+    else
+        deflateChunk(chunks.first());
+
+    qsizetype size = dest->size();
+    for (const DeflateChunk &chunk : std::as_const(chunks)) {
+        if (chunk.result != Z_OK)
+            return false;
+        size += chunk.compressed.size();
+    }
+
+    dest->reserve(size);
+    for (const DeflateChunk &chunk : std::as_const(chunks)) {
+        dest->append(chunk.compressed);
+        *crc = ::crc32_combine(*crc, chunk.crc, chunk.sourceLen);
+    }
+    return true;
+}
+
+static bool parallelDeflate(QByteArray *dest, uLong *crc, const QByteArray &source, int level)
+{
+    QByteArray data;
+    uLong result = ::crc32(0, nullptr, 0);
+    if (!deflateChunks(&data, &result, source, 0, true, level))
+        return false;
+
+    *dest = data;
+    *crc = result;
+    return true;
+}
+
 
 namespace WindowsFileAttributes {
 enum {
@@ -474,10 +599,139 @@ public:
     }
 
     void scanFiles();
+    bool seekToFileData(const QString &fileName, FileHeader *header, int *compressionMethod);
 
     QtZipReader::Status status;
 };
 
+/*
+    Reads a single entry of the archive, inflating it in chunks as it is read.
+*/
+class QtZipEntryDevice : public QIODevice
+{
+public:
+    QtZipEntryDevice(QIODevice *archive, qint64 offset, qint64 compressedSize, qint64 uncompressedSize, bool deflated)
+        : archive(archive), offset(offset), remaining(compressedSize), uncompressedSize(uncompressedSize),
+        deflated(deflated), finished(false)
+    {
+        stream.next_in = nullptr;
+        stream.avail_in = 0;
+        stream.zalloc = (alloc_func)nullptr;
+        stream.zfree = (free_func)nullptr;
+        stream.opaque = (voidpf)nullptr;
+        if (deflated && inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+            this->deflated = false;
+            finished = true;
+        }
+        open(QIODevice::ReadOnly);
+    }
+
+    ~QtZipEntryDevice()
+    {
+        if (deflated)
+            inflateEnd(&stream);
+    }
+
+    bool isSequential() const override
+    {
+        return true;
+    }
+
+    qint64 size() const override
+    {
+        return uncompressedSize;
+    }
+
+    qint64 bytesAvailable() const override
+    {
+        return (finished ? 0 : 1) + QIODevice::bytesAvailable();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+
+    qint64 writeData(const char *, qint64) override
+    {
+        return -1;
+    }
+
+private:
+    bool readInput(qint64 maxSize);
+
+    QIODevice *archive;
+    qint64 offset;
+    qint64 remaining;
+    qint64 uncompressedSize;
+    bool deflated;
+    bool finished;
+    z_stream stream;
+    QByteArray input;
+};
+
+bool QtZipEntryDevice::readInput(qint64 maxSize)
+{
+    if (remaining <= 0 || !archive->seek(offset)) {
+        return false;
+    }
+    input = archive->read(qMin(remaining, maxSize));
+    if (input.isEmpty()) {
+        return false;
+    }
+    offset += input.size();
+    remaining -= input.size();
+    return true;
+}
+
+qint64 QtZipEntryDevice::readData(char *data, qint64 maxSize)
+{
+    if (finished)
+        return -1;
+
+    // Stored entries are copied straight from the archive
+    if (!deflated) {
+        if (!readInput(maxSize)) {
+            finished = true;
+            return -1;
+        }
+        memcpy(data, input.constData(), input.size());
+        if (remaining <= 0)
+            finished = true;
+        return input.size();
+    }
+
+    // Inflate only as much as was requested
+    stream.next_out = reinterpret_cast<Bytef *>(data);
+    stream.avail_out = uInt(qMin<qint64>(maxSize, std::numeric_limits<uInt>::max()));
+    const uInt requested = stream.avail_out;
+    while (stream.avail_out > 0) {
+        if (stream.avail_in == 0) {
+            if (!readInput(0x10000)) {
+                qWarning("QtZip: Z_DATA_ERROR: Input data is truncated");
+                finished = true;
+                break;
+            }
+            stream.next_in = reinterpret_cast<Bytef *>(input.data());
+            stream.avail_in = uInt(input.size());
+        }
+
+        const int res = inflate(&stream, Z_NO_FLUSH);
+        if (res == Z_STREAM_END) {
+            finished = true;
+            break;
+        } else if (res != Z_OK) {
+            if (res == Z_MEM_ERROR)
+                qWarning("QtZip: Z_MEM_ERROR: Not enough memory");
+            else
+                qWarning("QtZip: Z_DATA_ERROR: Input data is corrupted");
+            finished = true;
+            break;
+        }
+    }
+
+    const qint64 count = requested - stream.avail_out;
+    return (count > 0 || !finished) ? count : -1;
+}
+
 class QtZipWriterPrivate : public QtZipPrivate
 {
 public:
@@ -485,19 +739,70 @@ public:
         : QtZipPrivate(device, ownDev),
         status(QtZipWriter::NoError),
         permissions(QFile::ReadOwner | QFile::WriteOwner),
-        compressionPolicy(QtZipWriter::AlwaysCompress)
+        compressionPolicy(QtZipWriter::AlwaysCompress),
+        compressionLevel(Z_DEFAULT_COMPRESSION)
     {
     }
 
     QtZipWriter::Status status;
     QFile::Permissions permissions;
     QtZipWriter::CompressionPolicy compressionPolicy;
+    int compressionLevel;
 
     enum EntryType { Directory, File, Symlink };
 
+    void initHeader(FileHeader *header, EntryType type, const QString &fileName, bool compressed);
+    void writeLocalHeader(const FileHeader &header);
     void addEntry(EntryType type, const QString &fileName, const QByteArray &contents);
 };
 
+/*
+    Writes a single file into the archive, compressing it in batches of
+    chunks as it is written. The sizes and checksum of the file are filled
+    in once the device is closed.
+*/
+class QtZipEntryWriter : public QIODevice
+{
+public:
+    QtZipEntryWriter(QtZipWriterPrivate *zip, const QString &fileName);
+
+    ~QtZipEntryWriter()
+    {
+        QtZipEntryWriter::close();
+    }
+
+    bool isSequential() const override
+    {
+        return true;
+    }
+
+    void close() override;
+
+protected:
+    qint64 readData(char *, qint64) override
+    {
+        return -1;
+    }
+
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    bool flush(bool last);
+    bool writeToArchive(const QByteArray &data);
+
+    QtZipWriterPrivate *zip;
+    FileHeader header;
+    qint64 headerOffset;
+    bool compressed;
+    bool failed;
+    uLong crc;
+    qint64 compressedSize;
+    qint64 uncompressedSize;
+    QByteArray pending;
+    qsizetype dictionaryLen;
+    qsizetype batchSize;
+};
+
 static LocalFileHeader toLocalHeader(const CentralFileHeader &ch)
 {
     LocalFileHeader h;
@@ -629,23 +934,24 @@ void QtZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const
     }
 
     FileHeader header;
-    memset(&header.h, 0, sizeof(CentralFileHeader));
-    writeUInt(header.h.signature, 0x02014b50);
+    initHeader(&header, type, fileName, compression == QtZipWriter::AlwaysCompress);
 
-    writeUShort(header.h.version_needed, ZIP_VERSION);
     writeUInt(header.h.uncompressed_size, contents.length());
-    writeMSDosDate(header.h.last_mod_file, QDateTime::currentDateTime());
     QByteArray data = contents;
+    uLong crc_32 = ::crc32(0, nullptr, 0);
+    bool compressedInParallel = false;
     if (compression == QtZipWriter::AlwaysCompress) {
-        writeUShort(header.h.compression_method, CompressionMethodDeflated);
-
+        if (contents.length() >= ParallelDeflateMinimumSize && QThread::idealThreadCount() > 1)
+            compressedInParallel = parallelDeflate(&data, &crc_32, contents, compressionLevel);
+    }
+    if (compression == QtZipWriter::AlwaysCompress && !compressedInParallel) {
        ulong len = contents.length();
         // shamelessly copied form zlib
         len += (len >> 12) + (len >> 14) + 11;
         int res;
         do {
             data.resize(len);
-            res = deflate((uchar*)data.data(), &len, (const uchar*)contents.constData(), contents.length());
+            res = deflate((uchar*)data.data(), &len, (const uchar*)contents.constData(), contents.length(), compressionLevel);
 
             switch (res) {
             case Z_OK:
@@ -663,28 +969,46 @@ void QtZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const
     }
 // TODO add a check if data.length() > contents.length().  Then try to store the original and revert the compression method to be uncompressed
     writeUInt(header.h.compressed_size, data.length());
-    uint crc_32 = ::crc32(0, nullptr, 0);
-    crc_32 = ::crc32(crc_32, (const uchar *)contents.constData(), contents.length());
+    if (!compressedInParallel)
+        crc_32 = ::crc32(crc_32, (const uchar *)contents.constData(), contents.length());
     writeUInt(header.h.crc_32, crc_32);
 
+    fileHeaders.append(header);
+
+    writeLocalHeader(header);
+    device->write(data);
+    start_of_directory = device->pos();
+    dirtyFileTree = true;
+}
+
+void QtZipWriterPrivate::initHeader(FileHeader *header, EntryType type, const QString &fileName, bool compressed)
+{
+    memset(&header->h, 0, sizeof(CentralFileHeader));
+    writeUInt(header->h.signature, 0x02014b50);
+
+    writeUShort(header->h.version_needed, ZIP_VERSION);
+    writeMSDosDate(header->h.last_mod_file, QDateTime::currentDateTime());
+    if (compressed)
+        writeUShort(header->h.compression_method, CompressionMethodDeflated);
+
     // if bit 11 is set, the filename and comment fields must be encoded using UTF-8
     ushort general_purpose_bits = Utf8Names; // always use utf-8
-    writeUShort(header.h.general_purpose_bits, general_purpose_bits);
+    writeUShort(header->h.general_purpose_bits, general_purpose_bits);
 
     const bool inUtf8 = (general_purpose_bits & Utf8Names) != 0;
-    header.file_name = inUtf8 ? fileName.toUtf8() : fileName.toLocal8Bit();
-    if (header.file_name.size() > 0xffff) {
+    header->file_name = inUtf8 ? fileName.toUtf8() : fileName.toLocal8Bit();
+    if (header->file_name.size() > 0xffff) {
         qWarning("QtZip: Filename is too long, chopping it to 65535 bytes");
-        header.file_name = header.file_name.left(0xffff); // ### don't break the utf-8 sequence, if any
+        header->file_name = header->file_name.left(0xffff); // ### don't break the utf-8 sequence, if any
     }
-    if (header.file_comment.size() + header.file_name.size() > 0xffff) {
+    if (header->file_comment.size() + header->file_name.size() > 0xffff) {
         qWarning("QtZip: File comment is too long, chopping it to 65535 bytes");
-        header.file_comment.truncate(0xffff - header.file_name.size()); // ### don't break the utf-8 sequence, if any
+        header->file_comment.truncate(0xffff - header->file_name.size()); // ### don't break the utf-8 sequence, if any
     }
-    writeUShort(header.h.file_name_length, header.file_name.length());
+    writeUShort(header->h.file_name_length, header->file_name.length());
     //h.extra_field_length[2];
 
-    writeUShort(header.h.version_made, HostUnix << 8);
+    writeUShort(header->h.version_made, HostUnix << 8);
     //uchar internal_file_attributes[2];
     //uchar external_file_attributes[4];
     quint32 mode = permissionsToMode(permissions);
@@ -702,18 +1026,111 @@ void QtZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const
         Q_UNREACHABLE();
         break;
     }
-    writeUInt(header.h.external_file_attributes, mode << 16);
-    writeUInt(header.h.offset_local_header, start_of_directory);
-
-
-    fileHeaders.append(header);
+    writeUInt(header->h.external_file_attributes, mode << 16);
+    writeUInt(header->h.offset_local_header, start_of_directory);
+}
 
+void QtZipWriterPrivate::writeLocalHeader(const FileHeader &header)
+{
     LocalFileHeader h = toLocalHeader(header.h);
     device->write((const char *)&h, sizeof(LocalFileHeader));
     device->write(header.file_name);
-    device->write(data);
-    start_of_directory = device->pos();
-    dirtyFileTree = true;
+}
+
+QtZipEntryWriter::QtZipEntryWriter(QtZipWriterPrivate *zip, const QString &fileName)
+    : zip(zip), headerOffset(0), compressed(zip->compressionPolicy != QtZipWriter::NeverCompress),
+    failed(false), crc(::crc32(0, nullptr, 0)), compressedSize(0), uncompressedSize(0), dictionaryLen(0),
+    batchSize(qsizetype(ParallelDeflateChunkSize) * qMax(1, QThread::idealThreadCount()))
+{
+    if (! (zip->device->isOpen() || zip->device->open(QIODevice::WriteOnly))) {
+        zip->status = QtZipWriter::FileOpenError;
+        return;
+    }
+    zip->device->seek(zip->start_of_directory);
+
+    // sizes and checksum are written when the device is closed
+    zip->initHeader(&header, QtZipWriterPrivate::File, fileName, compressed);
+    headerOffset = zip->start_of_directory;
+    zip->writeLocalHeader(header);
+
+    open(QIODevice::WriteOnly);
+}
+
+void QtZipEntryWriter::close()
+{
+    if (!isOpen())
+        return;
+
+    QIODevice::close();
+
+    if (compressed && !flush(true))
+        failed = true;
+
+    if (failed) {
+        // leave the partial entry out of the directory so that it is overwritten
+        zip->device->seek(headerOffset);
+        if (zip->status == QtZipWriter::NoError)
+            zip->status = QtZipWriter::FileWriteError;
+        return;
+    }
+
+    writeUInt(header.h.crc_32, crc);
+    writeUInt(header.h.compressed_size, compressedSize);
+    writeUInt(header.h.uncompressed_size, uncompressedSize);
+    zip->fileHeaders.append(header);
+
+    const qint64 end = zip->device->pos();
+    zip->device->seek(headerOffset);
+    zip->writeLocalHeader(header);
+    zip->device->seek(end);
+    zip->start_of_directory = end;
+    zip->dirtyFileTree = true;
+}
+
+qint64 QtZipEntryWriter::writeData(const char *data, qint64 len)
+{
+    if (failed)
+        return -1;
+
+    uncompressedSize += len;
+
+    if (!compressed) {
+        crc = ::crc32(crc, reinterpret_cast<const Bytef*>(data), uInt(len));
+        if (!writeToArchive(QByteArray::fromRawData(data, len)))
+            return -1;
+        return len;
+    }
+
+    pending.append(data, len);
+    if ((pending.size() - dictionaryLen) >= batchSize && !flush(false))
+        return -1;
+    return len;
+}
+
+bool QtZipEntryWriter::flush(bool last)
+{
+    QByteArray data;
+    if (!deflateChunks(&data, &crc, pending, dictionaryLen, last, zip->compressionLevel)) {
+        qWarning("QtZip: Unable to compress file");
+        failed = true;
+        return false;
+    }
+
+    // keep the end of the written data to prime the next batch
+    dictionaryLen = qMin<qsizetype>(pending.size(), ParallelDeflateDictionarySize);
+    pending.remove(0, pending.size() - dictionaryLen);
+
+    return writeToArchive(data);
+}
+
+bool QtZipEntryWriter::writeToArchive(const QByteArray &data)
+{
+    if (zip->device->write(data) != data.size()) {
+        failed = true;
+        return false;
+    }
+    compressedSize += data.size();
+    return true;
 }
 
 //////////////////////////////  Reader
@@ -902,47 +1319,58 @@ QtZipReader::FileInfo QtZipReader::entryInfoAt(int index) const
     return QtZipReader::FileInfo();
 }
 
-/*!
-    Fetch the file contents from the zip archive and return the uncompressed bytes.
-*/
-QByteArray QtZipReader::fileData(const QString &fileName) const
+bool QtZipReaderPrivate::seekToFileData(const QString &fileName, FileHeader *header, int *compressionMethod)
 {
-    d->scanFiles();
+    scanFiles();
     int i;
-    for (i = 0; i < d->fileHeaders.size(); ++i) {
-        if (QString::fromLocal8Bit(d->fileHeaders.at(i).file_name) == fileName)
+    for (i = 0; i < fileHeaders.size(); ++i) {
+        if (QString::fromLocal8Bit(fileHeaders.at(i).file_name) == fileName)
             break;
     }
-    if (i == d->fileHeaders.size())
-        return QByteArray();
+    if (i == fileHeaders.size())
+        return false;
 
-    FileHeader header = d->fileHeaders.at(i);
+    *header = fileHeaders.at(i);
 
-    ushort version_needed = readUShort(header.h.version_needed);
+    ushort version_needed = readUShort(header->h.version_needed);
     if (version_needed > ZIP_VERSION) {
         qWarning("QtZip: .ZIP specification version %d implementation is needed to extract the data.", version_needed);
     }
 
-    ushort general_purpose_bits = readUShort(header.h.general_purpose_bits);
-    int compressed_size = readUInt(header.h.compressed_size);
-    int uncompressed_size = readUInt(header.h.uncompressed_size);
-    int start = readUInt(header.h.offset_local_header);
+    ushort general_purpose_bits = readUShort(header->h.general_purpose_bits);
+    int start = readUInt(header->h.offset_local_header);
     //qDebug("uncompressing file %d: local header at %d", i, start);
 
-    d->device->seek(start);
+    device->seek(start);
     LocalFileHeader lh;
-    d->device->read((char *)&lh, sizeof(LocalFileHeader));
+    device->read((char *)&lh, sizeof(LocalFileHeader));
     uint skip = readUShort(lh.file_name_length) + readUShort(lh.extra_field_length);
-    d->device->seek(d->device->pos() + skip);
+    device->seek(device->pos() + skip);
 
-    int compression_method = readUShort(lh.compression_method);
-    //qDebug("file=%s: compressed_size=%d, uncompressed_size=%d", fileName.toLocal8Bit().data(), compressed_size, uncompressed_size);
+    *compressionMethod = readUShort(lh.compression_method);
 
     if ((general_purpose_bits & Encrypted) != 0) {
         qWarning("QtZip: Unsupported encryption method is needed to extract the data.");
-        return QByteArray();
+        return false;
     }
 
+    return true;
+}
+
+/*!
+    Fetch the file contents from the zip archive and return the uncompressed bytes.
+*/
+QByteArray QtZipReader::fileData(const QString &fileName) const
+{
+    FileHeader header;
+    int compression_method = 0;
+    if (!d->seekToFileData(fileName, &header, &compression_method))
+        return QByteArray();
+
+    int compressed_size = readUInt(header.h.compressed_size);
+    int uncompressed_size = readUInt(header.h.uncompressed_size);
+    //qDebug("file=%s: compressed_size=%d, uncompressed_size=%d", fileName.toLocal8Bit().data(), compressed_size, uncompressed_size);
+
     //qDebug("file at %lld", d->device->pos());
     QByteArray compressed = d->device->read(compressed_size);
     if (compression_method == CompressionMethodStored) {
@@ -984,6 +1412,34 @@ QByteArray QtZipReader::fileData(const QString &fileName) const
     return QByteArray();
 }
 
+/*!
+    Returns a device that reads the contents of \a fileName from the zip
+    archive, uncompressing them in chunks as they are read. The caller
+    takes ownership of the device. Returns \nullptr if the file could not
+    be found or uses an unsupported compression method.
+
+    The archive device must not be read from while the returned device
+    is in use.
+*/
+QIODevice *QtZipReader::fileDevice(const QString &fileName) const
+{
+    FileHeader header;
+    int compression_method = 0;
+    if (!d->seekToFileData(fileName, &header, &compression_method))
+        return nullptr;
+
+    const qint64 compressed_size = readUInt(header.h.compressed_size);
+    const qint64 uncompressed_size = readUInt(header.h.uncompressed_size);
+    if (compression_method == CompressionMethodStored) {
+        return new QtZipEntryDevice(d->device, d->device->pos(), qMin(compressed_size, uncompressed_size), uncompressed_size, false);
+    } else if (compression_method == CompressionMethodDeflated) {
+        return new QtZipEntryDevice(d->device, d->device->pos(), compressed_size, uncompressed_size, true);
+    }
+
+    qWarning("QtZip: Unsupported compression method %d is needed to extract the data.", compression_method);
+    return nullptr;
+}
+
 /*!
     Extracts the full contents of the zip file into \a destinationDir on
     the local filesystem.
@@ -1236,6 +1692,45 @@ QtZipWriter::CompressionPolicy QtZipWriter::compressionPolicy() const
     return d->compressionPolicy;
 }
 
+/*!
+     Sets the zlib compression \a level used for newly added files, from 0
+    (fastest) to 9 (smallest), or -1 for the zlib default.
+
+    Files larger than 256 KB are compressed on multiple threads.
+
+    \sa compressionLevel()
+    \sa setCompressionPolicy()
+*/
+void QtZipWriter::setCompressionLevel(int level)
+{
+    d->compressionLevel = qBound(Z_DEFAULT_COMPRESSION, level, Z_BEST_COMPRESSION);
+}
+
+/*!
+     Returns the currently set compression level.
+    \sa setCompressionLevel()
+*/
+int QtZipWriter::compressionLevel() const
+{
+    return d->compressionLevel;
+}
+
+/*!
+    Returns a device that adds a file named \a fileName to the archive.
+    Data written to the device is compressed in batches as it is written,
+    following the current compression policy, so that the full contents
+    never have to be held in memory. The file is finished when the device
+    is closed or deleted; the caller takes ownership of the device.
+
+    No other files can be added to the archive while the device is open.
+
+    \sa addFile()
+*/
+QIODevice *QtZipWriter::fileDevice(const QString &fileName)
+{
+    return new QtZipEntryWriter(d, QDir::fromNativeSeparators(fileName));
+}
+
 /*!
     Sets the permissions that will be used for newly added files.
 
@@ -43,6 +43,9 @@ public:
     void setCompressionPolicy(CompressionPolicy policy);
     CompressionPolicy compressionPolicy() const;
 
+    void setCompressionLevel(int level);
+    int compressionLevel() const;
+
     void setCreationPermissions(QFile::Permissions permissions);
     QFile::Permissions creationPermissions() const;
 
@@ -50,6 +53,8 @@ public:
 
     void addFile(const QString &fileName, QIODevice *device);
 
+    QIODevice *fileDevice(const QString &fileName);
+
     void addDirectory(const QString &dirName);
 
     void addSymLink(const QString &fileName, const QString &destination);
@@ -0,0 +1,200 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "block_counts.h"
+
+#include <QChar>
+#include <QtAlgorithms>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define FOCUSWRITER_SSE2
+#endif
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+enum CharacterClass
+{
+	OtherCharacter = 0x0,
+	WordCharacter = 0x1,
+	LetterCharacter = 0x2,
+	SpaceCharacter = 0x4,
+	JoinerCharacter = 0x8
+};
+
+struct Counts : BlockCounts
+{
+	bool word = false;
+};
+
+//-----------------------------------------------------------------------------
+
+quint8 classify(QChar c)
+{
+	if (c.isLetterOrNumber()) {
+		return WordCharacter | ((c.category() != QChar::Punctuation_Dash) ? LetterCharacter : 0);
+	} else if (c.isSpace()) {
+		return SpaceCharacter;
+	} else if (c == u'’' || c == '\'' || c == '-') {
+		return JoinerCharacter;
+	} else {
+		return OtherCharacter;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+// Classes of Latin-1 characters, built from the Unicode tables so that they always match
+struct Latin1Classes
+{
+	Latin1Classes()
+	{
+		for (int i = 0; i < 256; ++i) {
+			classes[i] = classify(QChar(i));
+		}
+	}
+
+	quint8 classes[256];
+};
+const Latin1Classes f_latin1;
+
+//-----------------------------------------------------------------------------
+
+inline void countCharacter(char16_t c, Counts& counts)
+{
+	const quint8 type = (c < 256) ? f_latin1.classes[c] : classify(QChar(c));
+	if (type & WordCharacter) {
+		counts.words += !counts.word;
+		counts.word = true;
+		counts.letters += ((type & LetterCharacter) != 0);
+	} else if (type & SpaceCharacter) {
+		counts.word = false;
+		counts.spaces++;
+	} else if (!(type & JoinerCharacter)) {
+		counts.word = false;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+#if defined(__AVX2__) || defined(FOCUSWRITER_SSE2)
+// Count a run of ASCII characters from bit masks of their classes
+inline void countMasks(quint32 word, quint32 space, quint32 joiner, int length, Counts& counts)
+{
+	// Joiners continue the state of the previous character
+	quint32 state = word;
+	while (joiner) {
+		const int i = qCountTrailingZeroBits(joiner);
+		const bool previous = i ? ((state >> (i - 1)) & 0x1) : counts.word;
+		state |= quint32(previous) << i;
+		joiner &= joiner - 1;
+	}
+
+	// Words start at word characters that do not follow a word state
+	const quint32 starts = word & ~((state << 1) | quint32(counts.word));
+	counts.words += qPopulationCount(starts);
+	counts.letters += qPopulationCount(word);
+	counts.spaces += qPopulationCount(space);
+	counts.word = (state >> (length - 1)) & 0x1;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+
+#if defined(__AVX2__)
+inline qsizetype countAscii(const char16_t* text, qsizetype length, Counts& counts)
+{
+	const __m256i non_ascii = _mm256_set1_epi16(short(0xff80));
+	const __m256i case_bit = _mm256_set1_epi8(0x20);
+	qsizetype i = 0;
+	for (; (i + 32) <= length; i += 32) {
+		const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+		const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + 16));
+		if (!_mm256_testz_si256(_mm256_or_si256(a, b), non_ascii)) {
+			for (qsizetype j = i, end = i + 32; j < end; ++j) {
+				countCharacter(text[j], counts);
+			}
+			continue;
+		}
+
+		const __m256i c = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+		const __m256i lower = _mm256_or_si256(c, case_bit);
+		const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+		const __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+		const __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')),
+				_mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('\t' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), c)));
+		const __m256i joiner = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\'')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('-')));
+
+		countMasks(quint32(_mm256_movemask_epi8(_mm256_or_si256(digit, alpha))),
+				quint32(_mm256_movemask_epi8(space)),
+				quint32(_mm256_movemask_epi8(joiner)),
+				32,
+				counts);
+	}
+	return i;
+}
+#elif defined(FOCUSWRITER_SSE2)
+inline qsizetype countAscii(const char16_t* text, qsizetype length, Counts& counts)
+{
+	const __m128i non_ascii = _mm_set1_epi16(short(0xff80));
+	const __m128i case_bit = _mm_set1_epi8(0x20);
+	qsizetype i = 0;
+	for (; (i + 16) <= length; i += 16) {
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + 8));
+		const __m128i high = _mm_and_si128(_mm_or_si128(a, b), non_ascii);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xffff) {
+			for (qsizetype j = i, end = i + 16; j < end; ++j) {
+				countCharacter(text[j], counts);
+			}
+			continue;
+		}
+
+		const __m128i c = _mm_packus_epi16(a, b);
+		const __m128i lower = _mm_or_si128(c, case_bit);
+		const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+		const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+		const __m128i space = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(' ')),
+				_mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('\r' + 1))));
+		const __m128i joiner = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('\'')), _mm_cmpeq_epi8(c, _mm_set1_epi8('-')));
+
+		countMasks(quint32(_mm_movemask_epi8(_mm_or_si128(digit, alpha))),
+				quint32(_mm_movemask_epi8(space)),
+				quint32(_mm_movemask_epi8(joiner)),
+				16,
+				counts);
+	}
+	return i;
+}
+#else
+inline qsizetype countAscii(const char16_t*, qsizetype, Counts&)
+{
+	return 0;
+}
+#endif
+
+}
+
+//-----------------------------------------------------------------------------
+
+BlockCounts countBlock(QStringView text)
+{
+	// Count runs of ASCII characters in bulk and the rest one at a time
+	Counts counts;
+	const char16_t* data = text.utf16();
+	const qsizetype length = text.length();
+	for (qsizetype i = countAscii(data, length, counts); i < length; ++i) {
+		countCharacter(data[i], counts);
+	}
+	return counts;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,22 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef FOCUSWRITER_BLOCK_COUNTS_H
+#define FOCUSWRITER_BLOCK_COUNTS_H
+
+#include <QStringView>
+
+// Statistics of a block of text, shared with the tests of the counting
+struct BlockCounts
+{
+	int letters = 0;
+	int spaces = 0;
+	int words = 0;
+};
+
+BlockCounts countBlock(QStringView text);
+
+#endif // FOCUSWRITER_BLOCK_COUNTS_H
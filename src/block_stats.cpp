@@ -1,23 +1,31 @@
 /*
-	SPDX-FileCopyrightText: 2009-2022 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2009-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
 
 #include "block_stats.h"
 
-#include "dictionary_ref.h"
+#include "block_counts.h"
 #include "scene_model.h"
+#include "word_index.h"
 
 //-----------------------------------------------------------------------------
 
-BlockStats::BlockStats(SceneModel* scene_model)
+static unsigned int f_revision = 0;
+
+//-----------------------------------------------------------------------------
+
+BlockStats::BlockStats(SceneModel* scene_model, WordIndex* word_index)
 	: m_characters(0)
 	, m_letters(0)
 	, m_spaces(0)
 	, m_words(0)
 	, m_scene(false)
 	, m_scene_model(scene_model)
+	, m_word_index(word_index)
+	, m_checked(Unchecked)
+	, m_revision(++f_revision)
 {
 }
 
@@ -29,19 +37,16 @@ BlockStats::~BlockStats()
 		Q_ASSERT(m_scene_model);
 		m_scene_model->removeScene(this);
 	}
+	if (m_word_index) {
+		m_word_index->removeBlock(this);
+	}
 }
 
 //-----------------------------------------------------------------------------
 
-void BlockStats::checkSpelling(const QString& text, const DictionaryRef& dictionary)
+void BlockStats::setMisspelled(const QList<WordRef>& misspelled)
 {
-	m_misspelled.clear();
-	if (!text.isEmpty()) {
-		WordRef word;
-		while ((word = dictionary.check(text, word.position() + word.length())).isNull() == false) {
-			m_misspelled.append(word);
-		}
-	}
+	m_misspelled = misspelled;
 	m_checked = Checked;
 }
 
@@ -50,24 +55,16 @@ void BlockStats::checkSpelling(const QString& text, const DictionaryRef& diction
 void BlockStats::update(const QString& text)
 {
 	m_checked = Unchecked;
+	m_revision = ++f_revision;
 	m_characters = text.length();
-	m_letters = 0;
-	m_spaces = 0;
-	m_words = 0;
-	bool word = false;
-	for (const QChar& c : text) {
-		if (c.isLetterOrNumber()) {
-			if (word == false) {
-				word = true;
-				m_words++;
-			}
-			m_letters += (c.category() != QChar::Punctuation_Dash);
-		} else if (c.isSpace()) {
-			word = false;
-			m_spaces++;
-		} else if (c != u'’' && c != '\'' && c != '-') {
-			word = false;
-		}
+
+	const BlockCounts counts = countBlock(text);
+	m_letters = counts.letters;
+	m_spaces = counts.spaces;
+	m_words = counts.words;
+
+	if (m_word_index) {
+		m_word_index->updateBlock(this, text);
 	}
 }
 
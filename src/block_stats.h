@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2009-2020 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2009-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -8,15 +8,15 @@
 #define FOCUSWRITER_BLOCK_STATS_H
 
 #include "word_ref.h"
-class DictionaryRef;
 class SceneModel;
+class WordIndex;
 
 #include <QTextBlockUserData>
 
 class BlockStats : public QTextBlockUserData
 {
 public:
-	explicit BlockStats(SceneModel* scene_model);
+	explicit BlockStats(SceneModel* scene_model, WordIndex* word_index = nullptr);
 	~BlockStats();
 
 	bool isEmpty() const;
@@ -26,6 +26,7 @@ public:
 	int spaceCount() const;
 	int wordCount() const;
 	QList<WordRef> misspelled() const;
+	unsigned int revision() const;
 
 	enum SpellCheckStatus
 	{
@@ -35,8 +36,8 @@ public:
 	};
 	SpellCheckStatus spellingStatus() const;
 
-	void checkSpelling(const QString& text, const DictionaryRef& dictionary);
 	void recheckSpelling();
+	void setMisspelled(const QList<WordRef>& misspelled);
 	void setScene(bool scene);
 	void update(const QString& text);
 
@@ -47,8 +48,10 @@ private:
 	int m_words;
 	bool m_scene;
 	SceneModel* m_scene_model;
+	WordIndex* m_word_index;
 	QList<WordRef> m_misspelled;
 	SpellCheckStatus m_checked;
+	unsigned int m_revision;
 };
 
 inline bool BlockStats::isEmpty() const
@@ -86,6 +89,11 @@ inline QList<WordRef> BlockStats::misspelled() const
 	return m_misspelled;
 }
 
+inline unsigned int BlockStats::revision() const
+{
+	return m_revision;
+}
+
 inline void BlockStats::setScene(bool scene)
 {
 	m_scene = scene;
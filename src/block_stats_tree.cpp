@@ -0,0 +1,195 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "block_stats_tree.h"
+
+#include "block_stats.h"
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+
+struct BlockStatsTree::Node
+{
+	explicit Node(const BlockStats* block)
+		: size(1)
+		, priority(QRandomGenerator::global()->generate())
+		, left(nullptr)
+		, right(nullptr)
+	{
+		stats.append(block);
+		total = stats;
+	}
+
+	~Node()
+	{
+		delete left;
+		delete right;
+	}
+
+	Stats stats;
+	Stats total;
+	int size;
+	quint32 priority;
+	Node* left;
+	Node* right;
+};
+
+//-----------------------------------------------------------------------------
+
+BlockStatsTree::BlockStatsTree()
+	: m_root(nullptr)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+BlockStatsTree::~BlockStatsTree()
+{
+	delete m_root;
+}
+
+//-----------------------------------------------------------------------------
+
+int BlockStatsTree::count() const
+{
+	return size(m_root);
+}
+
+//-----------------------------------------------------------------------------
+
+Stats BlockStatsTree::sum(int first, int last) const
+{
+	Stats result;
+	sum(m_root, std::max(first, 0), std::min(last, count()), result);
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+Stats BlockStatsTree::total() const
+{
+	return m_root ? m_root->total : Stats();
+}
+
+//-----------------------------------------------------------------------------
+
+void BlockStatsTree::clear()
+{
+	delete m_root;
+	m_root = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+
+void BlockStatsTree::replace(int index, int count, const QList<const BlockStats*>& blocks)
+{
+	Q_ASSERT(index >= 0);
+	Q_ASSERT(count >= 0);
+	Q_ASSERT((index + count) <= this->count());
+
+	// Detach replaced blocks
+	Node* left = nullptr;
+	Node* middle = nullptr;
+	Node* right = nullptr;
+	split(m_root, index, left, right);
+	split(right, count, middle, right);
+	delete middle;
+	middle = nullptr;
+
+	// Attach new blocks
+	for (const BlockStats* block : blocks) {
+		middle = merge(middle, new Node(block));
+	}
+	m_root = merge(merge(left, middle), right);
+}
+
+//-----------------------------------------------------------------------------
+
+BlockStatsTree::Node* BlockStatsTree::merge(Node* left, Node* right)
+{
+	if (!left) {
+		return right;
+	} else if (!right) {
+		return left;
+	}
+
+	if (left->priority > right->priority) {
+		left->right = merge(left->right, right);
+		update(left);
+		return left;
+	} else {
+		right->left = merge(left, right->left);
+		update(right);
+		return right;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void BlockStatsTree::split(Node* node, int index, Node*& left, Node*& right)
+{
+	if (!node) {
+		left = right = nullptr;
+		return;
+	}
+
+	if (size(node->left) < index) {
+		split(node->right, index - size(node->left) - 1, node->right, right);
+		left = node;
+	} else {
+		split(node->left, index, left, node->left);
+		right = node;
+	}
+	update(node);
+}
+
+//-----------------------------------------------------------------------------
+
+void BlockStatsTree::sum(const Node* node, int first, int last, Stats& result)
+{
+	if (!node || (first >= last)) {
+		return;
+	}
+
+	// Use cached total if entire subtree is in range
+	if ((first <= 0) && (last >= node->size)) {
+		result.append(node->total);
+		return;
+	}
+
+	const int left_size = size(node->left);
+	sum(node->left, first, std::min(last, left_size), result);
+	if ((first <= left_size) && (left_size < last)) {
+		result.append(node->stats);
+	}
+	sum(node->right, std::max(first - left_size - 1, 0), last - left_size - 1, result);
+}
+
+//-----------------------------------------------------------------------------
+
+int BlockStatsTree::size(const Node* node)
+{
+	return node ? node->size : 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void BlockStatsTree::update(Node* node)
+{
+	node->size = 1 + size(node->left) + size(node->right);
+	node->total = node->stats;
+	if (node->left) {
+		node->total.append(node->left->total);
+	}
+	if (node->right) {
+		node->total.append(node->right->total);
+	}
+}
+
+//-----------------------------------------------------------------------------
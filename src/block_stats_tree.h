@@ -0,0 +1,47 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef FOCUSWRITER_BLOCK_STATS_TREE_H
+#define FOCUSWRITER_BLOCK_STATS_TREE_H
+
+#include "stats.h"
+class BlockStats;
+
+#include <QList>
+
+// Stores the statistics of each block of a document in an implicit treap so
+// that blocks can be inserted, removed, and replaced, and any range of blocks
+// can be summed, in O(log n).
+class BlockStatsTree
+{
+public:
+	explicit BlockStatsTree();
+	~BlockStatsTree();
+
+	BlockStatsTree(const BlockStatsTree&) = delete;
+	BlockStatsTree& operator=(const BlockStatsTree&) = delete;
+
+	int count() const;
+	Stats sum(int first, int last) const;
+	Stats total() const;
+
+	void clear();
+	void replace(int index, int count, const QList<const BlockStats*>& blocks);
+
+private:
+	struct Node;
+
+	static Node* merge(Node* left, Node* right);
+	static void split(Node* node, int index, Node*& left, Node*& right);
+	static void sum(const Node* node, int first, int last, Stats& result);
+	static int size(const Node* node);
+	static void update(Node* node);
+
+private:
+	Node* m_root;
+};
+
+#endif // FOCUSWRITER_BLOCK_STATS_TREE_H
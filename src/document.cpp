@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2009-2022 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2009-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -8,8 +8,11 @@
 
 #include "alert.h"
 #include "block_stats.h"
+#include "block_xml_cache.h"
 #include "daily_progress.h"
 #include "dictionary_manager.h"
+#include "document_reader.h"
+#include "document_snapshot.h"
 #include "document_watcher.h"
 #include "docx_reader.h"
 #include "docx_writer.h"
@@ -28,13 +31,17 @@
 #include "spell_checker.h"
 #include "theme.h"
 #include "window.h"
+#include "word_index.h"
 
+#include <QtConcurrentRun>
 #include <QAbstractTextDocumentLayout>
 #include <QApplication>
 #include <QBuffer>
 #include <QDir>
+#include <QEventLoop>
 #include <QFile>
 #include <QFileDialog>
+#include <QFutureWatcher>
 #include <QGridLayout>
 #include <QMenu>
 #include <QMessageBox>
@@ -53,6 +60,8 @@
 #include <QTextBlock>
 #include <QTextDocumentFragment>
 #include <QTextEdit>
+#include <QThread>
+#include <QThreadPool>
 #include <QTimer>
 
 #include <algorithm>
@@ -76,6 +85,19 @@ static inline int cursorWidth()
 
 //-----------------------------------------------------------------------------
 
+static QThreadPool* savePool()
+{
+	// Limit how many files are written to disk at the same time
+	static QThreadPool* pool = nullptr;
+	if (!pool) {
+		pool = new QThreadPool(qApp);
+		pool->setMaxThreadCount(std::clamp(QThread::idealThreadCount(), 1, 4));
+	}
+	return pool;
+}
+
+//-----------------------------------------------------------------------------
+
 namespace
 {
 
@@ -391,6 +413,20 @@ void TextEdit::moveToBlockStart(QTextCursor::MoveMode mode)
 Document::Document(const QString& filename, DailyProgress* daily_progress, QWidget* parent)
 	: QWidget(parent)
 	, m_cache_outdated(false)
+	, m_cache_replace(false)
+	, m_changes(0)
+	, m_saving(false)
+	, m_save_pending(false)
+	, m_save_blocking(false)
+	, m_save_succeeded(false)
+	, m_save_changes(0)
+	, m_save_wordcount(0)
+	, m_load_reader(nullptr)
+	, m_load_cancelled(false)
+	, m_append_position(-1)
+	, m_appending(false)
+	, m_dormant(false)
+	, m_dormant_position(0)
 	, m_index(0)
 	, m_always_center(false)
 	, m_mouse_button_down(false)
@@ -399,8 +435,6 @@ Document::Document(const QString& filename, DailyProgress* daily_progress, QWidg
 	, m_focus_mode(0)
 	, m_scene_list(nullptr)
 	, m_dictionary(DictionaryManager::instance().requestDictionary())
-	, m_cached_block_count(-1)
-	, m_cached_current_block(-1)
 	, m_saved_wordcount(0)
 	, m_page_type(0)
 	, m_page_amount(0)
@@ -416,6 +450,13 @@ Document::Document(const QString& filename, DailyProgress* daily_progress, QWidg
 	m_hide_timer->setSingleShot(true);
 	connect(m_hide_timer, &QTimer::timeout, this, &Document::hideMouse);
 
+	m_append_timer = new QTimer(this);
+	m_append_timer->setInterval(10);
+	connect(m_append_timer, &QTimer::timeout, this, &Document::appendRemainingText);
+
+	m_save_watcher = new QFutureWatcher<bool>(this);
+	connect(m_save_watcher, &QFutureWatcherBase::finished, this, &Document::writeFinished);
+
 	// Set up text area
 	m_text = new TextEdit(this);
 	m_text->installEventFilter(this);
@@ -433,6 +474,7 @@ Document::Document(const QString& filename, DailyProgress* daily_progress, QWidg
 	connect(m_text->document(), &QTextDocument::modificationChanged, this, &Document::modificationChanged);
 
 	m_scene_model = new SceneModel(m_text, this);
+	m_word_index = new WordIndex(this);
 
 	m_highlighter = new Highlighter(m_text, m_dictionary);
 	connect(&DictionaryManager::instance(), &DictionaryManager::changed, this, &Document::dictionaryChanged);
@@ -479,6 +521,14 @@ Document::Document(const QString& filename, DailyProgress* daily_progress, QWidg
 
 Document::~Document()
 {
+	if (m_append_reader) {
+		m_append_reader->cancel();
+	}
+
+	if (m_saving) {
+		m_save_watcher->waitForFinished();
+	}
+
 	m_scene_model->removeAllScenes();
 
 	DocumentWatcher::instance()->removeWatch(this);
@@ -501,6 +551,19 @@ QString Document::title() const
 
 //-----------------------------------------------------------------------------
 
+int Document::cursorPosition() const
+{
+	if (m_dormant) {
+		return m_dormant_position;
+	} else if (m_append_position != -1) {
+		return m_append_position;
+	} else {
+		return m_text->textCursor().position();
+	}
+}
+
+//-----------------------------------------------------------------------------
+
 bool Document::isModified() const
 {
 	return m_text->document()->isModified();
@@ -515,58 +578,110 @@ bool Document::isReadOnly() const
 
 //-----------------------------------------------------------------------------
 
+qint64 Document::memoryUsage() const
+{
+	// Rough estimate of text, layout, and block data for each character
+	return m_dormant ? 0 : qint64(m_text->document()->characterCount()) * 32;
+}
+
+//-----------------------------------------------------------------------------
+
 void Document::cache()
 {
-	if (m_cache_outdated) {
+	// Cached copy is of the whole file, which is not all in the document yet
+	if (m_append_reader) {
+		return;
+	}
+
+	if (m_cache_outdated && !m_dormant) {
 		m_cache_outdated = false;
+
+		// Append changes to journal until it is worth replacing with a full copy
+		if (!m_cache_replace && (m_journal.size() < 1048576)) {
+			Q_EMIT writeCacheJournal(this, m_journal.takeChanges());
+			return;
+		}
+
+		m_cache_replace = false;
+		m_journal.clear();
 		QSharedPointer<DocumentWriter> writer(new DocumentWriter);
 		writer->setType(!m_filename.isEmpty() ? m_filename.section(QLatin1Char('.'), -1) : "odt");
 		writer->setWriteByteOrderMark(Preferences::instance().writeByteOrderMark());
-		writer->setDocument(m_text->document()->clone());
+		m_snapshot.reset(new DocumentSnapshot(m_text->document(), m_snapshot.data()));
+		writer->setSnapshot(m_snapshot);
+		if (!m_cache_blocks) {
+			m_cache_blocks.reset(new BlockXmlCache);
+		}
+		writer->setBlockCache(m_cache_blocks);
 		Q_EMIT writeCacheFile(this, writer);
 	}
 }
 
 //-----------------------------------------------------------------------------
 
+void Document::cacheFailed()
+{
+	// Cached copy and journal no longer match, so write a full copy next time
+	m_cache_replace = true;
+	m_cache_outdated = true;
+}
+
+//-----------------------------------------------------------------------------
+
 bool Document::save()
 {
 	// Save progress
 	m_daily_progress->save();
 
+	// Dormant documents are unmodified copies of the file
+	if (m_dormant) {
+		return true;
+	}
+
 	if (m_filename.isEmpty() || !processFileName(m_filename)) {
 		return saveAs();
 	}
 
-	// Write file to disk
-	DocumentWatcher::instance()->pauseWatch(this);
-	DocumentWriter writer;
-	writer.setFileName(m_filename);
-	writer.setType(m_filename.section(QLatin1Char('.'), -1));
-	writer.setWriteByteOrderMark(Preferences::instance().writeByteOrderMark());
-	writer.setDocument(m_text->document());
-	const bool saved = writer.write();
-	if (saved) {
-		m_cache_outdated = false;
-		Q_EMIT replaceCacheFile(this, m_filename);
-	} else {
-		cache();
+	// Write file to disk and wait for it and any pending save to finish
+	writeFile();
+	m_save_blocking = true;
+	while (m_saving) {
+		QEventLoop loop;
+		connect(m_save_watcher, &QFutureWatcherBase::finished, &loop, &QEventLoop::quit);
+		loop.exec(QEventLoop::ExcludeUserInputEvents);
 	}
-	DocumentWatcher::instance()->resumeWatch(this);
+	m_save_blocking = false;
 
-	if (!saved) {
+	if (!m_save_succeeded) {
 		QMessageBox::critical(window(), tr("Sorry"), tr("Unable to save '%1'.").arg(QDir::toNativeSeparators(m_filename)));
 		return false;
 	}
 
-	m_saved_wordcount = m_document_stats.wordCount();
-
-	m_text->document()->setModified(false);
 	return true;
 }
 
 //-----------------------------------------------------------------------------
 
+void Document::startSave()
+{
+	// Save progress
+	m_daily_progress->save();
+
+	// Dormant documents are unmodified copies of the file
+	if (m_dormant) {
+		return;
+	}
+
+	if (m_filename.isEmpty() || !processFileName(m_filename)) {
+		saveAs();
+		return;
+	}
+
+	writeFile();
+}
+
+//-----------------------------------------------------------------------------
+
 bool Document::saveAs()
 {
 	// Request new filename
@@ -635,8 +750,8 @@ bool Document::rename()
 
 void Document::reload(bool prompt)
 {
-	// Abort if there is no file to reload
-	if (m_index) {
+	// Abort if there is no file to reload; dormant documents read the file when woken
+	if (m_index || m_dormant) {
 		return;
 	}
 
@@ -660,13 +775,22 @@ void Document::reload(bool prompt)
 		}
 	}
 
+	// Keep all of current contents if reload is cancelled
+	finishAppending();
+
 	// Reload file
 	Q_EMIT loadStarted(Window::tr("Opening %1").arg(QDir::toNativeSeparators(m_filename)));
 	m_text->setReadOnly(true);
 	disconnect(m_text->document(), &QTextDocument::contentsChange, this, &Document::updateWordCount);
 	disconnect(m_text->document(), &QTextDocument::undoCommandAdded, this, &Document::undoCommandAdded);
 	m_daily_progress->increaseWordCount(-wordCountDelta());
-	loadFile(m_filename, -1);
+	if (!loadFile(m_filename, -1, true) && m_load_cancelled) {
+		// Keep current contents
+		m_daily_progress->increaseWordCount(wordCountDelta());
+		m_text->setReadOnly(!QFileInfo(m_filename).isWritable());
+		connect(m_text->document(), &QTextDocument::contentsChange, this, &Document::updateWordCount);
+		connect(m_text->document(), &QTextDocument::undoCommandAdded, this, &Document::undoCommandAdded);
+	}
 	Q_EMIT loadFinished();
 }
 
@@ -680,6 +804,55 @@ void Document::close()
 
 //-----------------------------------------------------------------------------
 
+bool Document::sleep()
+{
+	// Only documents that match their file can be read again later
+	if (m_dormant || m_load_reader || m_append_reader || m_saving || m_filename.isEmpty() || isModified() || !QFileInfo::exists(m_filename)) {
+		return false;
+	}
+
+	m_dormant_position = m_text->textCursor().position();
+	m_dormant_stats = m_block_stats.total();
+	m_dormant = true;
+	m_stats = &m_document_stats;
+	m_old_states.clear();
+
+	// Make sure cache matches file
+	if (m_cache_outdated) {
+		m_cache_outdated = false;
+		m_journal.clear();
+		Q_EMIT replaceCacheFile(this, m_filename);
+	}
+
+	// Discard contents but keep statistics
+	disconnect(m_text->document(), &QTextDocument::contentsChange, this, &Document::updateWordCount);
+	disconnect(m_text->document(), &QTextDocument::undoCommandAdded, this, &Document::undoCommandAdded);
+	replaceDocument(new QTextDocument);
+	m_block_stats.clear();
+	m_snapshot.reset();
+	m_cache_blocks.reset();
+	m_save_blocks.reset();
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool Document::wake()
+{
+	if (!m_dormant) {
+		return true;
+	}
+
+	Q_EMIT loadStarted(Window::tr("Opening %1").arg(QDir::toNativeSeparators(m_filename)));
+	const bool loaded = loadFile(m_filename, m_dormant_position);
+	Q_EMIT changed();
+	Q_EMIT loadFinished();
+	return loaded;
+}
+
+//-----------------------------------------------------------------------------
+
 void Document::checkSpelling()
 {
 	SpellChecker::checkDocument(m_text, m_dictionary);
@@ -788,6 +961,7 @@ void Document::print(QPrinter* printer)
 	}
 
 	// Clone document
+	finishAppending();
 	QTextDocument* document = m_text->document()->clone();
 
 	// Apply spacings
@@ -830,89 +1004,126 @@ void Document::print(QPrinter* printer)
 
 //-----------------------------------------------------------------------------
 
-bool Document::loadFile(const QString& filename, int position)
+bool Document::loadFile(const QString& filename, int position, bool cancellable)
 {
-	bool loaded = true;
-
 	if (filename.isEmpty()) {
+		m_load_cancelled = false;
 		m_text->setReadOnly(false);
 
 		scrollBarRangeChanged(m_scrollbar->minimum(), m_scrollbar->maximum());
 
+		buildBlockStats();
 		calculateWordCount();
 		connect(m_text->document(), &QTextDocument::contentsChange, this, &Document::updateWordCount);
 		connect(m_text->document(), &QTextDocument::undoCommandAdded, this, &Document::undoCommandAdded);
 
-		return loaded;
+		return true;
 	}
 
+	return loadFile(DocumentReader::start(filename, m_block_format), position, cancellable);
+}
+
+//-----------------------------------------------------------------------------
+
+bool Document::loadFile(const QSharedPointer<DocumentReader>& reader, int position, bool cancellable)
+{
+	bool loaded = true;
+	m_load_cancelled = false;
+
 	const bool enabled = m_highlighter->enabled();
 	m_highlighter->setEnabled(false);
 
-	// Cache contents
-	Q_EMIT replaceCacheFile(this, filename);
-
-	// Fetch reader for file
-	FormatReader* reader = nullptr;
-	QFile file(filename);
-	if (file.open(QIODevice::ReadOnly)) {
-		reader = FormatManager::createReader(&file, filename.section(QLatin1Char('.'), -1).toLower());
+	// Keep window responsive while file is read; load screen blocks input if it can be cancelled
+	const QFuture<void> future = reader->future();
+	if (!future.isFinished()) {
+		QEventLoop loop;
+		QFutureWatcher<void> watcher;
+		connect(&watcher, &QFutureWatcherBase::finished, &loop, &QEventLoop::quit);
+		watcher.setFuture(future);
+
+		QTimer progress_timer;
+		progress_timer.setInterval(100);
+		connect(&progress_timer, &QTimer::timeout, this, [this, reader] {
+			Q_EMIT loadProgress(reader->progress());
+		});
+
+		if (cancellable) {
+			m_load_reader = reader.data();
+			Q_EMIT loadProgress(0);
+			progress_timer.start();
+			loop.exec();
+			progress_timer.stop();
+			Q_EMIT loadProgress(-1);
+			m_load_reader = nullptr;
+		} else {
+			loop.exec(QEventLoop::ExcludeUserInputEvents);
+		}
 	}
 
-	// Load text area contents
-	QTextDocument* document = m_text->document();
-	m_text->blockSignals(true);
-	document->blockSignals(true);
-
-	document->setUndoRedoEnabled(false);
-	document->clear();
-	m_text->textCursor().mergeBlockFormat(m_block_format);
-	const qsizetype formats = document->allFormats().count();
-	if (reader) {
-		QString error;
-		reader->read(&file, document);
-		file.close();
-
-		if (reader->hasError()) {
-			error = reader->errorString();
-			loaded = false;
-			position = -1;
-		}
+	// Discard contents if cancelled
+	if (m_load_cancelled || reader->isCancelled()) {
+		m_load_cancelled = true;
+		m_highlighter->setEnabled(enabled);
+		return false;
+	}
 
-		if (!loaded) {
-			Q_EMIT alert(new Alert(Alert::Warning, error, QStringList(filename), false));
-			findIndex();
-		}
+	const QString filename = reader->fileName();
+	if (reader->hasError()) {
+		loaded = false;
+		position = -1;
+		Q_EMIT alert(new Alert(Alert::Warning, reader->errorString(), QStringList(filename), false));
+		findIndex();
 	}
 	if (m_filename.isEmpty()) {
-		m_rich_text = document->allFormats().count() > formats;
+		m_rich_text = reader->isRichText();
+	}
+	QTextDocument* document = reader->takeDocument();
+
+	// Add rest of plain text file now if it has already been read
+	const bool appending = !reader->remainingFuture().isFinished();
+	if (!appending) {
+		const QString text = reader->takeRemainingText();
+		if (!text.isEmpty()) {
+			document->setUndoRedoEnabled(false);
+			QTextCursor cursor(document);
+			cursor.movePosition(QTextCursor::End);
+			cursor.insertText(text);
+			document->setUndoRedoEnabled(true);
+			document->setModified(false);
+		}
 	}
-	document->setUndoRedoEnabled(true);
-	document->setModified(false);
 
-	document->blockSignals(false);
-	m_text->blockSignals(false);
+	// Cache contents
+	m_cache_outdated = false;
+	m_journal.clear();
+	m_snapshot.reset();
+	m_cache_blocks.reset();
+	m_save_blocks.reset();
+	Q_EMIT replaceCacheFile(this, filename);
 
+	// Replace text area contents
+	replaceDocument(document);
 	m_text->setReadOnly(!m_filename.isEmpty() ? !QFileInfo(m_filename).isWritable() : false);
 
 	// Update details
-	m_cached_stats.clear();
+	m_dormant = false;
+	buildBlockStats();
 	calculateWordCount();
 	m_saved_wordcount = m_document_stats.wordCount();
 	connect(m_text->document(), &QTextDocument::contentsChange, this, &Document::updateWordCount);
 	connect(m_text->document(), &QTextDocument::undoCommandAdded, this, &Document::undoCommandAdded);
 
 	// Force highlight before enabling spellcheck to prevent vertical shift from heading elements
-	for (QTextBlock i = document->begin(); i.isValid(); i = i.next()) {
-		m_highlighter->rehighlightBlock(i);
-		QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-	}
+	m_highlighter->rehighlight();
 	m_highlighter->setEnabled(enabled);
 
-	// Restore cursor position
+	// Restore cursor position, waiting for rest of plain text file if it is past the start
+	const bool defer_position = appending && (position >= m_text->document()->characterCount());
 	scrollBarRangeChanged(m_scrollbar->minimum(), m_scrollbar->maximum());
 	QTextCursor cursor = m_text->textCursor();
-	if (position != -1) {
+	if (defer_position) {
+		cursor.movePosition(QTextCursor::Start);
+	} else if (position != -1) {
 		cursor.setPosition(position);
 	} else {
 		cursor.movePosition(QTextCursor::End);
@@ -920,6 +1131,14 @@ bool Document::loadFile(const QString& filename, int position)
 	m_text->setTextCursor(cursor);
 	centerCursor(true);
 
+	// Append rest of plain text file while document can be edited; undo is unavailable until then
+	if (appending) {
+		m_append_reader = reader;
+		m_append_position = defer_position ? position : -1;
+		m_text->document()->setUndoRedoEnabled(false);
+		m_append_timer->start();
+	}
+
 	if (m_focus_mode) {
 		focusText();
 	}
@@ -939,6 +1158,11 @@ void Document::loadTheme(const Theme& theme)
 	// Update colors
 	m_text_color = theme.textColor();
 	m_text_color.setAlpha(255);
+	QColor highlight = m_text_color;
+	highlight.setAlpha(96);
+	for (QTextEdit::ExtraSelection& selection : m_highlights) {
+		selection.format.setBackground(highlight);
+	}
 	QColor text_color = m_text_color;
 	text_color.setAlpha(m_focus_mode ? 128 : 255);
 
@@ -953,11 +1177,7 @@ void Document::loadTheme(const Theme& theme)
 
 	// Update spacings
 	const int tab_width = theme.tabWidth();
-	m_block_format = QTextBlockFormat();
-	m_block_format.setLineHeight(theme.lineSpacing(), (theme.lineSpacing() == 100) ? QTextBlockFormat::SingleHeight : QTextBlockFormat::ProportionalHeight);
-	m_block_format.setTextIndent(tab_width * theme.indentFirstLine());
-	m_block_format.setTopMargin(theme.spacingAboveParagraph());
-	m_block_format.setBottomMargin(theme.spacingBelowParagraph());
+	m_block_format = blockFormat(theme);
 	if (m_spacings_loaded) {
 		for (int i = 0, count = m_text->document()->allFormats().count(); i < count; ++i) {
 			QTextFormat& f = m_text->document()->allFormats()[i];
@@ -1018,9 +1238,7 @@ void Document::loadTheme(const Theme& theme)
 		break;
 	}
 
-	if (m_focus_mode) {
-		focusText();
-	}
+	focusText();
 
 	centerCursor(true);
 	m_text->document()->blockSignals(false);
@@ -1046,9 +1264,7 @@ void Document::loadPreferences()
 	}
 
 	m_wordcount_type = Preferences::instance().wordcountType();
-	if (m_cached_block_count != -1) {
-		calculateWordCount();
-	}
+	calculateWordCount();
 
 	m_block_cursor = Preferences::instance().blockCursor();
 	m_text->setCursorWidth(!m_block_cursor ? cursorWidth() : m_text->fontMetrics().averageCharWidth());
@@ -1084,12 +1300,30 @@ void Document::setFocusMode(int focus_mode)
 		disconnect(m_text, &QTextEdit::cursorPositionChanged, this, &Document::focusText);
 		disconnect(m_text, &QTextEdit::selectionChanged, this, &Document::focusText);
 		disconnect(m_text, &QTextEdit::textChanged, this, &Document::focusText);
-		m_text->setExtraSelections(QList<QTextEdit::ExtraSelection>());
+		focusText();
 	}
 }
 
 //-----------------------------------------------------------------------------
 
+void Document::setHighlights(const QList<QTextCursor>& highlights)
+{
+	// Build marks once, since focus mode sets them again whenever the cursor moves
+	QColor highlight = m_text_color;
+	highlight.setAlpha(96);
+	m_highlights.clear();
+	m_highlights.reserve(highlights.count());
+	for (const QTextCursor& cursor : highlights) {
+		QTextEdit::ExtraSelection selection;
+		selection.format.setBackground(highlight);
+		selection.cursor = cursor;
+		m_highlights.append(selection);
+	}
+	focusText();
+}
+
+//-----------------------------------------------------------------------------
+
 void Document::setRichText(bool rich_text)
 {
 	if (m_rich_text == rich_text) {
@@ -1139,6 +1373,18 @@ void Document::setSceneList(SceneList* scene_list)
 
 //-----------------------------------------------------------------------------
 
+QTextBlockFormat Document::blockFormat(const Theme& theme)
+{
+	QTextBlockFormat format;
+	format.setLineHeight(theme.lineSpacing(), (theme.lineSpacing() == 100) ? QTextBlockFormat::SingleHeight : QTextBlockFormat::ProportionalHeight);
+	format.setTextIndent(theme.tabWidth() * theme.indentFirstLine());
+	format.setTopMargin(theme.spacingAboveParagraph());
+	format.setBottomMargin(theme.spacingBelowParagraph());
+	return format;
+}
+
+//-----------------------------------------------------------------------------
+
 bool Document::eventFilter(QObject* watched, QEvent* event)
 {
 	if (event->type() == QEvent::MouseMove) {
@@ -1189,6 +1435,16 @@ void Document::mouseMoveEvent(QMouseEvent* event)
 
 //-----------------------------------------------------------------------------
 
+void Document::cancelLoad()
+{
+	if (m_load_reader) {
+		m_load_cancelled = true;
+		m_load_reader->cancel();
+	}
+}
+
+//-----------------------------------------------------------------------------
+
 void Document::centerCursor(bool force)
 {
 	const QRect cursor = m_text->cursorRect();
@@ -1225,6 +1481,7 @@ void Document::wheelEvent(QWheelEvent* event)
 
 void Document::cursorPositionChanged()
 {
+	m_append_position = -1;
 	Q_EMIT indentChanged(m_text->textCursor().blockFormat().indent());
 	Q_EMIT alignmentChanged();
 	if (!m_mouse_button_down) {
@@ -1236,6 +1493,12 @@ void Document::cursorPositionChanged()
 
 void Document::focusText()
 {
+	// Show marked matches of the find dialog
+	if (!m_focus_mode) {
+		m_text->setExtraSelections(m_highlights);
+		return;
+	}
+
 	QTextEdit::ExtraSelection selection;
 	selection.format.setForeground(m_text_color);
 	selection.cursor = m_text->textCursor();
@@ -1262,7 +1525,7 @@ void Document::focusText()
 		break;
 	}
 
-	QList<QTextEdit::ExtraSelection> selections;
+	QList<QTextEdit::ExtraSelection> selections = m_highlights;
 	selections.append(selection);
 	m_text->setExtraSelections(selections);
 }
@@ -1315,11 +1578,23 @@ void Document::dictionaryChanged()
 void Document::selectionChanged()
 {
 	m_selected_stats.clear();
-	if (m_text->textCursor().hasSelection()) {
+	const QTextCursor cursor = m_text->textCursor();
+	if (cursor.hasSelection()) {
+		const int start = cursor.selectionStart();
+		const int end = cursor.selectionEnd();
+		const QTextBlock first = m_text->document()->findBlock(start);
+		const QTextBlock last = m_text->document()->findBlock(end);
+
+		// Only scan the partially selected text of the first and last blocks
 		BlockStats temp(nullptr);
-		const QStringList selection = m_text->textCursor().selectedText().split(QChar::ParagraphSeparator, Qt::SkipEmptyParts);
-		for (const QString& string : selection) {
-			temp.update(string);
+		if (first == last) {
+			temp.update(first.text().mid(start - first.position(), end - start));
+			m_selected_stats.append(&temp);
+		} else {
+			temp.update(first.text().mid(start - first.position()));
+			m_selected_stats.append(&temp);
+			m_selected_stats.append(m_block_stats.sum(first.blockNumber() + 1, last.blockNumber()));
+			temp.update(last.text().left(end - last.position()));
 			m_selected_stats.append(&temp);
 		}
 		m_selected_stats.calculateWordCount(m_wordcount_type);
@@ -1349,9 +1624,51 @@ void Document::undoCommandAdded()
 
 //-----------------------------------------------------------------------------
 
+void Document::writeFinished()
+{
+	DocumentWatcher::instance()->resumeWatch(this);
+	m_saving = false;
+	m_save_succeeded = m_save_watcher->result();
+
+	if (m_save_succeeded) {
+		m_saved_wordcount = m_save_wordcount;
+
+		// Only mark as saved if nothing changed while file was written
+		if ((m_save_changes == m_changes) && (m_save_filename == m_filename)) {
+			m_cache_outdated = false;
+			m_journal.clear();
+			Q_EMIT replaceCacheFile(this, m_filename);
+			m_text->document()->setModified(false);
+		}
+	} else {
+		cache();
+		if (!m_save_blocking) {
+			Q_EMIT alert(new Alert(Alert::Critical, tr("Unable to save '%1'.").arg(QDir::toNativeSeparators(m_save_filename)), QStringList(), false));
+		}
+	}
+
+	// Write changes made since save started
+	if (m_save_pending) {
+		m_save_pending = false;
+		if (!m_save_succeeded || (m_save_changes != m_changes) || (m_save_filename != m_filename)) {
+			writeFile();
+		}
+	}
+
+	if (!m_saving) {
+		Q_EMIT saveFinished(m_save_succeeded);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
 void Document::updateWordCount(int position, int removed, int added)
 {
 	m_cache_outdated = true;
+	++m_changes;
+	if (!m_append_reader) {
+		m_journal.addChange(m_text->document(), position, removed, added);
+	}
 
 	// Change filename and rich text status if necessary because of undo/redo
 	const int steps = m_text->document()->availableUndoSteps();
@@ -1372,13 +1689,6 @@ void Document::updateWordCount(int position, int removed, int added)
 		}
 	}
 
-	// Clear cached stats if amount of blocks or current block has changed
-	const int block_count = m_text->document()->blockCount();
-	const int current_block = m_text->textCursor().blockNumber();
-	if (m_cached_block_count != block_count || m_cached_current_block != current_block) {
-		m_cached_stats.clear();
-	}
-
 	// Update stats of blocks that were modified
 	QTextBlock begin = m_text->document()->findBlock(position - removed);
 	if (!begin.isValid()) {
@@ -1389,65 +1699,131 @@ void Document::updateWordCount(int position, int removed, int added)
 		end = end.next();
 	}
 	bool update_spelling = false;
+	QList<const BlockStats*> blocks;
 	BlockStats* stats = nullptr;
 	for (QTextBlock i = begin; i != end; i = i.next()) {
 		stats = static_cast<BlockStats*>(i.userData());
 		if (!stats) {
-			stats = new BlockStats(m_scene_model);
+			stats = new BlockStats(m_scene_model, m_word_index);
 			i.setUserData(stats);
-			m_cached_stats.clear();
 			update_spelling = true;
 		}
 		stats->update(i.text());
 		stats->recheckSpelling();
 		m_scene_model->updateScene(stats, i);
+		blocks.append(stats);
 	}
 	if (update_spelling) {
 		m_highlighter->updateSpelling();
 	}
 
-	// Update document stats and daily word count
+	// Replace stats of the blocks that were in the modified range before the change
+	const int first = begin.blockNumber();
+	const int last = end.isValid() ? end.blockNumber() : m_text->document()->blockCount();
+	const int replaced = (last - first) - (m_text->document()->blockCount() - m_block_stats.count());
+	if ((replaced >= 0) && ((first + replaced) <= m_block_stats.count())) {
+		m_block_stats.replace(first, replaced, blocks);
+	} else {
+		buildBlockStats();
+	}
+
+	// Update document stats and daily word count; appended text was not typed
 	const int words = m_document_stats.wordCount();
 	calculateWordCount();
-	m_daily_progress->increaseWordCount(m_document_stats.wordCount() - words);
+	if (!m_appending) {
+		m_daily_progress->increaseWordCount(m_document_stats.wordCount() - words);
+	} else {
+		m_saved_wordcount += m_document_stats.wordCount() - words;
+	}
 	Q_EMIT changed();
 }
 
 //-----------------------------------------------------------------------------
 
-void Document::calculateWordCount()
+void Document::appendRemainingText()
 {
-	// Cache stats of the blocks other than the current block
-	if (!m_cached_stats.isValid()) {
-		m_cached_block_count = m_text->document()->blockCount();
-		m_cached_current_block = m_text->textCursor().blockNumber();
-
-		BlockStats* stats = nullptr;
-		for (QTextBlock i = m_text->document()->begin(); i.isValid(); i = i.next()) {
-			if (!i.userData()) {
-				stats = new BlockStats(m_scene_model);
-				i.setUserData(stats);
-				stats->update(i.text());
-				m_scene_model->updateScene(stats, i);
-			}
-			if (i.blockNumber() != m_cached_current_block) {
-				m_cached_stats.append(static_cast<BlockStats*>(i.userData()));
-			}
-		}
+	const bool finished = m_append_reader->remainingFuture().isFinished();
+
+	// Add text that has been read so far to end of document
+	const QString text = m_append_reader->takeRemainingText();
+	if (!text.isEmpty()) {
+		const bool modified = isModified();
+		m_appending = true;
+		QTextCursor cursor(m_text->document());
+		cursor.movePosition(QTextCursor::End);
+		cursor.insertText(text);
+		m_appending = false;
+		m_text->document()->setModified(modified);
+	}
+
+	if (!finished) {
+		return;
+	}
+
+	m_append_timer->stop();
+	m_append_reader.reset();
+	m_text->document()->setUndoRedoEnabled(true);
+
+	// Cached copy is of the file, so only keep it if it has not been edited
+	m_journal.clear();
+	m_cache_replace = isModified();
+	m_cache_outdated = m_cache_replace;
+
+	// Restore cursor position that was past the start
+	if (m_append_position != -1) {
+		QTextCursor cursor = m_text->textCursor();
+		cursor.setPosition(qMin(m_append_position, m_text->document()->characterCount() - 1));
+		m_text->setTextCursor(cursor);
+		centerCursor(true);
+		m_append_position = -1;
 	}
+}
+
+//-----------------------------------------------------------------------------
+
+void Document::buildBlockStats()
+{
+	QList<const BlockStats*> blocks;
+	blocks.reserve(m_text->document()->blockCount());
 
-	// Determine document stats by adding cached stats to current block stats
-	m_document_stats = m_cached_stats;
-	const QTextBlockUserData* data = m_text->document()->findBlockByNumber(m_cached_current_block).userData();
-	if (data) {
-		m_document_stats.append(static_cast<const BlockStats*>(data));
+	BlockStats* stats = nullptr;
+	for (QTextBlock i = m_text->document()->begin(); i.isValid(); i = i.next()) {
+		stats = static_cast<BlockStats*>(i.userData());
+		if (!stats) {
+			stats = new BlockStats(m_scene_model, m_word_index);
+			i.setUserData(stats);
+			stats->update(i.text());
+			m_scene_model->updateScene(stats, i);
+		}
+		blocks.append(stats);
 	}
+
+	m_block_stats.clear();
+	m_block_stats.replace(0, 0, blocks);
+}
+
+//-----------------------------------------------------------------------------
+
+void Document::calculateWordCount()
+{
+	m_document_stats = !m_dormant ? m_block_stats.total() : m_dormant_stats;
 	m_document_stats.calculateWordCount(m_wordcount_type);
 	m_document_stats.calculatePageCount(m_page_type, m_page_amount);
 }
 
 //-----------------------------------------------------------------------------
 
+void Document::finishAppending()
+{
+	// Wait for rest of plain text file so that the whole file is used
+	if (m_append_reader) {
+		m_append_reader->remainingFuture().waitForFinished();
+		appendRemainingText();
+	}
+}
+
+//-----------------------------------------------------------------------------
+
 void Document::clearIndex()
 {
 	if (m_index) {
@@ -1466,6 +1842,65 @@ void Document::findIndex()
 
 //-----------------------------------------------------------------------------
 
+void Document::replaceDocument(QTextDocument* document)
+{
+	++m_changes;
+	m_text->blockSignals(true);
+
+	QTextDocument* previous = m_text->document();
+	const bool owned = (previous->parent() == m_text);
+	document->setParent(m_text);
+	document->setDefaultFont(previous->defaultFont());
+	document->setIndentWidth(previous->indentWidth());
+	document->setDefaultTextOption(previous->defaultTextOption());
+	m_text->setDocument(document);
+	m_highlights.clear();
+	if (owned) {
+		delete previous;
+	}
+	m_highlighter->setTextDocument(document);
+	m_scene_model->connectDocument();
+	connect(document, &QTextDocument::modificationChanged, this, &Document::modificationChanged);
+
+	m_text->blockSignals(false);
+}
+
+//-----------------------------------------------------------------------------
+
+void Document::writeFile()
+{
+	// Combine with save that is already in progress
+	if (m_saving) {
+		m_save_pending = true;
+		return;
+	}
+
+	// Write snapshot of document in background
+	finishAppending();
+	QSharedPointer<DocumentWriter> writer(new DocumentWriter);
+	writer->setFileName(m_filename);
+	writer->setType(m_filename.section(QLatin1Char('.'), -1));
+	writer->setWriteByteOrderMark(Preferences::instance().writeByteOrderMark());
+	m_snapshot.reset(new DocumentSnapshot(m_text->document(), m_snapshot.data()));
+	writer->setSnapshot(m_snapshot);
+	if (!m_save_blocks) {
+		m_save_blocks.reset(new BlockXmlCache);
+	}
+	writer->setBlockCache(m_save_blocks);
+
+	m_saving = true;
+	m_save_changes = m_changes;
+	m_save_filename = m_filename;
+	m_save_wordcount = m_document_stats.wordCount();
+
+	DocumentWatcher::instance()->pauseWatch(this);
+	m_save_watcher->setFuture(QtConcurrent::run(savePool(), [writer] {
+		return writer->write();
+	}));
+}
+
+//-----------------------------------------------------------------------------
+
 QString Document::getSaveFileName(const QString& title)
 {
 	// Determine filter
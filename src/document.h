@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2009-2016 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2009-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -7,25 +7,33 @@
 #ifndef FOCUSWRITER_DOCUMENT_H
 #define FOCUSWRITER_DOCUMENT_H
 
+#include "block_stats_tree.h"
 #include "dictionary_ref.h"
+#include "document_journal.h"
 #include "document_writer.h"
 #include "stats.h"
 class Alert;
+class BlockXmlCache;
 class DailyProgress;
+class DocumentReader;
+class DocumentSnapshot;
 class Highlighter;
 class SceneList;
 class SceneModel;
 class Theme;
+class WordIndex;
 
+#include <QFutureWatcher>
 #include <QHash>
 #include <QSharedPointer>
 #include <QTextBlockFormat>
+#include <QTextEdit>
 #include <QTime>
 #include <QWidget>
 class QGridLayout;
 class QScrollBar;
 class QPrinter;
-class QTextEdit;
+class QTextDocument;
 class QTimer;
 
 class Document : public QWidget
@@ -39,49 +47,67 @@ public:
 	QString filename() const;
 	QString title() const;
 	int untitledIndex() const;
+	int cursorPosition() const;
+	bool isDormant() const;
+	bool isLoadCancelled() const;
 	bool isModified() const;
 	bool isReadOnly() const;
 	bool isRichText() const;
+	bool isSaving() const;
 	int characterCount() const;
 	int characterAndSpaceCount() const;
 	int pageCount() const;
 	int paragraphCount() const;
 	int wordCount() const;
 	int wordCountDelta() const;
+	qint64 memoryUsage() const;
 	SceneModel* sceneModel() const;
 	QTextEdit* text() const;
+	WordIndex* wordIndex() const;
 
 	void cache();
+	void cacheFailed();
 	bool save();
+	void startSave();
 	bool saveAs();
 	bool rename();
 	void reload(bool prompt = true);
 	void close();
+	bool sleep();
+	bool wake();
 	void checkSpelling();
 	void print(QPrinter* printer);
-	bool loadFile(const QString& filename, int position);
+	bool loadFile(const QString& filename, int position, bool cancellable = false);
+	bool loadFile(const QSharedPointer<DocumentReader>& reader, int position, bool cancellable = false);
 	void loadTheme(const Theme& theme);
 	void loadPreferences();
 	void setFocusMode(int focus_mode);
+	void setHighlights(const QList<QTextCursor>& highlights);
 	void setModified(bool modified);
 	void setRichText(bool rich_text);
 	void setScrollBarVisible(bool visible);
 	void setSceneList(SceneList* scene_list);
 
+	static QTextBlockFormat blockFormat(const Theme& theme);
+
 	bool eventFilter(QObject* watched, QEvent* event) override;
 	void mouseMoveEvent(QMouseEvent* event) override;
 
 public Q_SLOTS:
+	void cancelLoad();
 	void centerCursor(bool force = false);
 
 Q_SIGNALS:
 	void alert(Alert* alert);
 	void replaceCacheFile(const Document* document, const QString& file);
 	void writeCacheFile(const Document* document, QSharedPointer<DocumentWriter> writer);
+	void writeCacheJournal(const Document* document, const QByteArray& changes);
 	void changed();
 	void changedName();
 	void loadStarted(const QString& path);
+	void loadProgress(int progress);
 	void loadFinished();
+	void saveFinished(bool saved);
 	void footerVisible(bool visible);
 	void headerVisible(bool visible);
 	void scenesVisible(bool visible);
@@ -100,14 +126,20 @@ private Q_SLOTS:
 	void scrollBarActionTriggered(int action);
 	void scrollBarRangeChanged(int min, int max);
 	void dictionaryChanged();
+	void writeFinished();
 	void selectionChanged();
 	void undoCommandAdded();
 	void updateWordCount(int position, int removed, int added);
+	void appendRemainingText();
 
 private:
+	void finishAppending();
+	void buildBlockStats();
 	void calculateWordCount();
 	void clearIndex();
 	void findIndex();
+	void replaceDocument(QTextDocument* document);
+	void writeFile();
 	QString getSaveFileName(const QString& title);
 	bool processFileName(const QString& filename);
 	void updateSaveLocation();
@@ -118,6 +150,28 @@ private:
 	QString m_filename;
 	QString m_default_format;
 	bool m_cache_outdated;
+	bool m_cache_replace;
+	unsigned int m_changes;
+	QFutureWatcher<bool>* m_save_watcher;
+	bool m_saving;
+	bool m_save_pending;
+	bool m_save_blocking;
+	bool m_save_succeeded;
+	unsigned int m_save_changes;
+	QString m_save_filename;
+	int m_save_wordcount;
+	DocumentJournal m_journal;
+	QSharedPointer<const DocumentSnapshot> m_snapshot;
+	QSharedPointer<BlockXmlCache> m_cache_blocks;
+	QSharedPointer<BlockXmlCache> m_save_blocks;
+	DocumentReader* m_load_reader;
+	bool m_load_cancelled;
+	QSharedPointer<DocumentReader> m_append_reader;
+	QTimer* m_append_timer;
+	int m_append_position;
+	bool m_appending;
+	bool m_dormant;
+	int m_dormant_position;
 	QHash<int, QPair<QString, bool>> m_old_states;
 	int m_index;
 	bool m_always_center;
@@ -135,6 +189,8 @@ private:
 	QScrollBar* m_scrollbar;
 	SceneList* m_scene_list;
 	SceneModel* m_scene_model;
+	WordIndex* m_word_index;
+	QList<QTextEdit::ExtraSelection> m_highlights;
 	DictionaryRef m_dictionary;
 	Highlighter* m_highlighter;
 	QColor m_text_color;
@@ -142,9 +198,8 @@ private:
 	Stats* m_stats;
 	Stats m_document_stats;
 	Stats m_selected_stats;
-	Stats m_cached_stats;
-	int m_cached_block_count;
-	int m_cached_current_block;
+	BlockStatsTree m_block_stats;
+	Stats m_dormant_stats;
 	int m_saved_wordcount;
 
 	int m_page_type;
@@ -165,11 +220,26 @@ inline int Document::untitledIndex() const
 	return m_index;
 }
 
+inline bool Document::isDormant() const
+{
+	return m_dormant;
+}
+
+inline bool Document::isLoadCancelled() const
+{
+	return m_load_cancelled;
+}
+
 inline bool Document::isRichText() const
 {
 	return m_rich_text;
 }
 
+inline bool Document::isSaving() const
+{
+	return m_saving;
+}
+
 inline int Document::characterCount() const
 {
 	return m_stats->characterCount();
@@ -210,4 +280,9 @@ inline QTextEdit* Document::text() const
 	return m_text;
 }
 
+inline WordIndex* Document::wordIndex() const
+{
+	return m_word_index;
+}
+
 #endif // FOCUSWRITER_DOCUMENT_H
@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2012-2022 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2012-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -7,6 +7,9 @@
 #include "document_cache.h"
 
 #include "document.h"
+#include "document_journal.h"
+#include "format_manager.h"
+#include "format_reader.h"
 #include "stack.h"
 
 #include <QDateTime>
@@ -14,6 +17,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QRandomGenerator>
+#include <QTextDocument>
 #include <QTextStream>
 
 #include <algorithm>
@@ -72,6 +76,7 @@ void DocumentCache::parseMapping(QStringList& files, QStringList& datafiles) con
 			if (!datafile.isEmpty()) {
 				files.append(path);
 				datafiles.append(cache_path + "/" + datafile);
+				replayJournal(datafiles.constLast(), !path.isEmpty() ? path.section(QLatin1Char('.'), -1).toLower() : "odt");
 			}
 		}
 		file.close();
@@ -86,6 +91,7 @@ void DocumentCache::add(const Document* document)
 	connect(document, &Document::changedName, this, &DocumentCache::updateMapping);
 	connect(document, &Document::replaceCacheFile, this, &DocumentCache::replaceCacheFile);
 	connect(document, &Document::writeCacheFile, this, &DocumentCache::writeCacheFile);
+	connect(document, &Document::writeCacheJournal, this, &DocumentCache::writeCacheJournal);
 	updateMapping();
 }
 
@@ -95,8 +101,10 @@ void DocumentCache::remove(const Document* document)
 {
 	if (m_filenames.contains(document)) {
 		const QString cache_file = m_filenames.take(document);
+		m_outdated.remove(document);
 		updateMapping();
 		QFile::remove(cache_file);
+		QFile::remove(DocumentJournal::fileName(m_path + cache_file));
 	}
 }
 
@@ -144,6 +152,10 @@ void DocumentCache::replaceCacheFile(const Document* document, const QString& fi
 	const QString cache_file = createFileName();
 	if (QFile::copy(file, m_path + cache_file)) {
 		updateCacheFile(document, cache_file);
+	} else {
+		// Journal would no longer match cached copy
+		m_outdated.insert(document);
+		Q_EMIT cacheFailed(document);
 	}
 }
 
@@ -155,6 +167,32 @@ void DocumentCache::writeCacheFile(const Document* document, QSharedPointer<Docu
 	writer->setFileName(m_path + cache_file);
 	if (writer->write()) {
 		updateCacheFile(document, cache_file);
+	} else {
+		// Journal would no longer match cached copy
+		QFile::remove(m_path + cache_file);
+		m_outdated.insert(document);
+		Q_EMIT cacheFailed(document);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void DocumentCache::writeCacheJournal(const Document* document, const QByteArray& changes)
+{
+	if (!m_filenames.contains(document)) {
+		return;
+	}
+
+	// Changes can not be applied to outdated cached copy; ask for full copy again instead
+	if (m_outdated.contains(document)) {
+		Q_EMIT cacheFailed(document);
+		return;
+	}
+
+	QFile file(DocumentJournal::fileName(m_path + m_filenames[document]));
+	if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+		file.write(changes);
+		file.close();
 	}
 }
 
@@ -205,6 +243,45 @@ QString DocumentCache::createFileName() const
 
 //-----------------------------------------------------------------------------
 
+void DocumentCache::replayJournal(const QString& cache_file, const QString& type) const
+{
+	const QString journal = DocumentJournal::fileName(cache_file);
+	if (!QFile::exists(journal)) {
+		return;
+	}
+
+	// Read cached copy; documents that were never cached start empty
+	QTextDocument* document = new QTextDocument;
+	document->setUndoRedoEnabled(false);
+	QFile file(cache_file);
+	if (file.open(QIODevice::ReadOnly)) {
+		FormatReader* reader = FormatManager::createReader(&file, type);
+		reader->read(&file, document);
+		const bool error = reader->hasError();
+		delete reader;
+		file.close();
+		if (error) {
+			delete document;
+			return;
+		}
+	}
+
+	// Apply changes and replace cached copy; keep cached copy untouched if changes do not match it
+	if (DocumentJournal::replay(journal, document)) {
+		DocumentWriter writer;
+		writer.setFileName(cache_file);
+		writer.setType(type);
+		writer.setDocument(document);
+		if (writer.write()) {
+			QFile::remove(journal);
+		}
+	} else {
+		delete document;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
 void DocumentCache::updateCacheFile(const Document* document, const QString& cache_file)
 {
 	// Ensure new filenames only
@@ -214,13 +291,18 @@ void DocumentCache::updateCacheFile(const Document* document, const QString& cac
 
 	// Swap cache filename
 	QFile old_cache_file(m_path + m_filenames[document]);
+	QFile old_journal_file(DocumentJournal::fileName(old_cache_file.fileName()));
 	m_filenames[document] = cache_file;
+	m_outdated.remove(document);
 	updateMapping();
 
-	// Delete old cache file
+	// Delete old cache file and its journal
 	if (old_cache_file.exists()) {
 		old_cache_file.remove();
 	}
+	if (old_journal_file.exists()) {
+		old_journal_file.remove();
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2012-2013 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2012-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -13,6 +13,7 @@ class Stack;
 
 #include <QHash>
 #include <QObject>
+#include <QSet>
 #include <QSharedPointer>
 
 class DocumentCache : public QObject
@@ -36,18 +37,24 @@ public:
 public Q_SLOTS:
 	void updateMapping() const;
 
+Q_SIGNALS:
+	void cacheFailed(const Document* document);
+
 private Q_SLOTS:
 	void replaceCacheFile(const Document* document, const QString& file);
 	void writeCacheFile(const Document* document, QSharedPointer<DocumentWriter> writer);
+	void writeCacheJournal(const Document* document, const QByteArray& changes);
 
 private:
 	QString backupCache() const;
 	QString createFileName() const;
+	void replayJournal(const QString& cache_file, const QString& type) const;
 	void updateCacheFile(const Document* document, const QString& cache_file);
 
 private:
 	Stack* m_ordering;
 	QHash<const Document*, QString> m_filenames;
+	QSet<const Document*> m_outdated;
 	QString m_previous_cache;
 
 	static QString m_path;
@@ -0,0 +1,184 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "document_journal.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+enum ChangePart
+{
+	SetBlockFormat,
+	InsertBlock,
+	InsertText
+};
+
+}
+
+//-----------------------------------------------------------------------------
+
+DocumentJournal::DocumentJournal()
+	: m_written(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+void DocumentJournal::addChange(const QTextDocument* document, int position, int removed, int added)
+{
+	// Ignore final paragraph separator, which can not be changed
+	const int last = document->characterCount() - 1;
+	position = std::clamp(position, 0, last);
+	const int end = std::clamp(position + added, position, last);
+
+	// Store position and length of replaced text, and length of document afterwards
+	QByteArray change;
+	QDataStream stream(&change, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_6_0);
+	stream << qint32(position) << qint32(removed) << qint32(document->characterCount());
+
+	// Store blocks and text that replaced it
+	for (QTextBlock block = document->findBlock(position); block.isValid() && (block.position() <= end); block = block.next()) {
+		stream << quint8((block.position() > position) ? InsertBlock : SetBlockFormat) << block.blockFormat() << block.charFormat();
+
+		for (QTextBlock::iterator i = block.begin(); !i.atEnd(); ++i) {
+			const QTextFragment fragment = i.fragment();
+			const int start = std::max(fragment.position(), position);
+			const int stop = std::min(fragment.position() + fragment.length(), end);
+			if (start < stop) {
+				stream << quint8(InsertText) << fragment.text().mid(start - fragment.position(), stop - start) << fragment.charFormat();
+			}
+		}
+	}
+
+	// Append change with its size so that partly written changes can be detected
+	QDataStream journal(&m_changes, QIODevice::WriteOnly | QIODevice::Append);
+	journal.setVersion(QDataStream::Qt_6_0);
+	journal << change;
+}
+
+//-----------------------------------------------------------------------------
+
+void DocumentJournal::clear()
+{
+	m_changes.clear();
+	m_written = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+QByteArray DocumentJournal::takeChanges()
+{
+	m_written += m_changes.size();
+	QByteArray changes;
+	std::swap(changes, m_changes);
+	return changes;
+}
+
+//-----------------------------------------------------------------------------
+
+QString DocumentJournal::fileName(const QString& cache_file)
+{
+	return cache_file + QLatin1String(".journal");
+}
+
+//-----------------------------------------------------------------------------
+
+bool DocumentJournal::replay(const QString& filename, QTextDocument* document)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+
+	QDataStream journal(&file);
+	journal.setVersion(QDataStream::Qt_6_0);
+
+	bool replayed = false;
+	QTextCursor cursor(document);
+	while (!journal.atEnd()) {
+		// Stop at change that was only partly written
+		QByteArray change;
+		journal >> change;
+		if (journal.status() != QDataStream::Ok) {
+			break;
+		}
+
+		QDataStream stream(change);
+		stream.setVersion(QDataStream::Qt_6_0);
+		qint32 position = 0;
+		qint32 removed = 0;
+		qint32 length = 0;
+		stream >> position >> removed >> length;
+		if (stream.status() != QDataStream::Ok) {
+			return false;
+		}
+
+		// Refuse changes that do not fit cached copy; removed text can include final paragraph separator
+		const int last = document->characterCount() - 1;
+		if ((position < 0) || (position > last) || (removed < 0) || (position + removed > last + 1)) {
+			return false;
+		}
+
+		// Remove replaced text
+		cursor.setPosition(position);
+		cursor.setPosition(std::min(position + removed, last), QTextCursor::KeepAnchor);
+		cursor.removeSelectedText();
+
+		// Insert blocks and text
+		while (!stream.atEnd()) {
+			quint8 part = 0;
+			QTextFormat block_format;
+			QTextFormat char_format;
+			QString text;
+			stream >> part;
+			if (part == InsertText) {
+				stream >> text >> char_format;
+			} else {
+				stream >> block_format >> char_format;
+			}
+			if (stream.status() != QDataStream::Ok) {
+				return false;
+			}
+
+			switch (part) {
+			case SetBlockFormat:
+				cursor.setBlockFormat(block_format.toBlockFormat());
+				cursor.setBlockCharFormat(char_format.toCharFormat());
+				break;
+			case InsertBlock:
+				cursor.insertBlock(block_format.toBlockFormat(), char_format.toCharFormat());
+				break;
+			case InsertText:
+				cursor.insertText(text, char_format.toCharFormat());
+				break;
+			default:
+				return false;
+			}
+		}
+
+		// Refuse changes if cached copy differs from document they were recorded from
+		if (document->characterCount() != length) {
+			return false;
+		}
+
+		replayed = true;
+	}
+
+	return replayed;
+}
+
+//-----------------------------------------------------------------------------
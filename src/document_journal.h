@@ -0,0 +1,45 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef FOCUSWRITER_DOCUMENT_JOURNAL_H
+#define FOCUSWRITER_DOCUMENT_JOURNAL_H
+
+#include <QByteArray>
+#include <QString>
+class QTextDocument;
+
+// Records changes to a document so that they can be replayed on top of its cached copy
+class DocumentJournal
+{
+public:
+	explicit DocumentJournal();
+
+	bool isEmpty() const;
+	qint64 size() const;
+
+	void addChange(const QTextDocument* document, int position, int removed, int added);
+	void clear();
+	QByteArray takeChanges();
+
+	static QString fileName(const QString& cache_file);
+	static bool replay(const QString& filename, QTextDocument* document);
+
+private:
+	QByteArray m_changes;
+	qint64 m_written;
+};
+
+inline bool DocumentJournal::isEmpty() const
+{
+	return m_changes.isEmpty();
+}
+
+inline qint64 DocumentJournal::size() const
+{
+	return m_written + m_changes.size();
+}
+
+#endif // FOCUSWRITER_DOCUMENT_JOURNAL_H
@@ -0,0 +1,194 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "document_reader.h"
+
+#include "format_manager.h"
+#include "format_reader.h"
+#include "txt_reader.h"
+
+#include <QtConcurrentRun>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextCursor>
+#include <QTextDocument>
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+// Amount of plain text read before document is shown
+const qsizetype head_length = 0x40000;
+
+// Amount of file decoded at a time for rest of plain text
+const qint64 remaining_chunk_size = 0x10000;
+
+}
+
+//-----------------------------------------------------------------------------
+
+DocumentReader::DocumentReader(const QString& filename, const QTextBlockFormat& block_format)
+	: m_filename(filename)
+	, m_block_format(block_format)
+	, m_document(nullptr)
+	, m_rich_text(false)
+	, m_file(nullptr)
+	, m_reader(nullptr)
+	, m_cancelled(false)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+DocumentReader::~DocumentReader()
+{
+	// Document belongs to main thread, which might not be the current thread
+	if (m_document) {
+		m_document->deleteLater();
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+QSharedPointer<DocumentReader> DocumentReader::start(const QString& filename, const QTextBlockFormat& block_format)
+{
+	QSharedPointer<DocumentReader> reader(new DocumentReader(filename, block_format));
+	reader->m_future = QtConcurrent::run([reader] {
+		reader->read();
+	});
+	reader->m_remaining_future = reader->m_future.then(QtFuture::Launch::Async, [reader] {
+		reader->readRemaining();
+	});
+	return reader;
+}
+
+//-----------------------------------------------------------------------------
+
+bool DocumentReader::isCancelled() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_cancelled;
+}
+
+//-----------------------------------------------------------------------------
+
+int DocumentReader::progress() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_reader ? m_reader->progress() : 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void DocumentReader::cancel()
+{
+	QMutexLocker locker(&m_mutex);
+	m_cancelled = true;
+	if (m_reader) {
+		m_reader->cancel();
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+QTextDocument* DocumentReader::takeDocument()
+{
+	Q_ASSERT(m_future.isFinished());
+	QTextDocument* document = m_document;
+	m_document = nullptr;
+	return document;
+}
+
+//-----------------------------------------------------------------------------
+
+QString DocumentReader::takeRemainingText()
+{
+	QMutexLocker locker(&m_mutex);
+	QString text = m_remaining_text;
+	m_remaining_text.clear();
+	return text;
+}
+
+//-----------------------------------------------------------------------------
+
+void DocumentReader::read()
+{
+	// Fetch reader for file
+	FormatReader* reader = nullptr;
+	m_file = new QFile(m_filename);
+	if (m_file->open(QIODevice::ReadOnly)) {
+		reader = FormatManager::createReader(m_file, m_filename.section(QLatin1Char('.'), -1).toLower());
+	} else {
+		m_error = m_file->errorString();
+	}
+
+	// Use theme spacings
+	QTextDocument* document = new QTextDocument;
+	document->setUndoRedoEnabled(false);
+	QTextCursor(document).mergeBlockFormat(m_block_format);
+	const qsizetype formats = document->allFormats().count();
+
+	// Read file contents
+	if (reader) {
+		m_mutex.lock();
+		m_reader = reader;
+		if (m_cancelled) {
+			reader->cancel();
+		}
+		m_mutex.unlock();
+
+		// Show start of plain text files without waiting for the rest
+		if (reader->type() == TxtReader::Type) {
+			static_cast<TxtReader*>(reader)->setHeadLength(head_length);
+		}
+
+		reader->read(m_file, document);
+		m_error = reader->errorString();
+	}
+	m_rich_text = document->allFormats().count() > formats;
+	document->setUndoRedoEnabled(true);
+	document->setModified(false);
+
+	// Hand document to main thread
+	if (!isCancelled()) {
+		document->moveToThread(QCoreApplication::instance()->thread());
+		m_document = document;
+	} else {
+		delete document;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void DocumentReader::readRemaining()
+{
+	// Read rest of plain text file for main thread to append
+	if (m_reader && (m_reader->type() == TxtReader::Type)) {
+		TxtReader* reader = static_cast<TxtReader*>(m_reader);
+		while (!reader->atEnd()) {
+			const QString text = reader->readBatch(remaining_chunk_size);
+			if (text.isEmpty()) {
+				break;
+			}
+
+			QMutexLocker locker(&m_mutex);
+			m_remaining_text += text;
+		}
+	}
+
+	// Reader must be deleted before file because it maps file into memory
+	m_mutex.lock();
+	FormatReader* reader = m_reader;
+	m_reader = nullptr;
+	m_mutex.unlock();
+	delete reader;
+
+	delete m_file;
+	m_file = nullptr;
+}
+
+//-----------------------------------------------------------------------------
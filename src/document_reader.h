@@ -0,0 +1,96 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef FOCUSWRITER_DOCUMENT_READER_H
+#define FOCUSWRITER_DOCUMENT_READER_H
+
+class FormatReader;
+
+#include <QFuture>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QTextBlockFormat>
+class QFile;
+class QTextDocument;
+
+// Reads a file into a detached document in a separate thread; long plain text
+// files stop after the start, and the rest is read afterward as text to append
+class DocumentReader
+{
+public:
+	~DocumentReader();
+
+	static QSharedPointer<DocumentReader> start(const QString& filename, const QTextBlockFormat& block_format);
+
+	QString errorString() const;
+	QString fileName() const;
+	QFuture<void> future() const;
+	bool hasError() const;
+	bool isCancelled() const;
+	bool isRichText() const;
+	int progress() const;
+	QFuture<void> remainingFuture() const;
+
+	void cancel();
+	QTextDocument* takeDocument();
+	QString takeRemainingText();
+
+private:
+	explicit DocumentReader(const QString& filename, const QTextBlockFormat& block_format);
+
+	void read();
+	void readRemaining();
+
+private:
+	QString m_filename;
+	QTextBlockFormat m_block_format;
+	QFuture<void> m_future;
+	QFuture<void> m_remaining_future;
+
+	QTextDocument* m_document;
+	QString m_error;
+	bool m_rich_text;
+
+	QFile* m_file;
+
+	mutable QMutex m_mutex;
+	FormatReader* m_reader;
+	QString m_remaining_text;
+	bool m_cancelled;
+};
+
+inline QString DocumentReader::errorString() const
+{
+	return m_error;
+}
+
+inline QString DocumentReader::fileName() const
+{
+	return m_filename;
+}
+
+inline QFuture<void> DocumentReader::future() const
+{
+	return m_future;
+}
+
+inline QFuture<void> DocumentReader::remainingFuture() const
+{
+	return m_remaining_future;
+}
+
+inline bool DocumentReader::hasError() const
+{
+	return !m_error.isEmpty();
+}
+
+inline bool DocumentReader::isRichText() const
+{
+	return m_rich_text;
+}
+
+#endif // FOCUSWRITER_DOCUMENT_READER_H
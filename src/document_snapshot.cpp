@@ -0,0 +1,101 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "document_snapshot.h"
+
+#include "block_stats.h"
+
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+
+//-----------------------------------------------------------------------------
+
+DocumentSnapshot::DocumentSnapshot(const QTextDocument* document, const DocumentSnapshot* previous)
+	: m_formats(document->allFormats())
+{
+	m_blocks.reserve(document->blockCount());
+	m_revisions.reserve(document->blockCount());
+
+	for (QTextBlock i = document->begin(); i.isValid(); i = i.next()) {
+		// Only copy blocks that have changed since previous snapshot
+		const BlockStats* stats = static_cast<BlockStats*>(i.userData());
+		if (!stats) {
+			m_blocks.append(createBlock(i, 0));
+			continue;
+		}
+
+		QSharedPointer<const Block> block;
+		if (previous) {
+			block = previous->m_revisions.value(stats->revision());
+		}
+		if (!block) {
+			block = createBlock(i, stats->revision());
+		}
+		m_blocks.append(block);
+		m_revisions.insert(stats->revision(), block);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+QTextDocument* DocumentSnapshot::createDocument() const
+{
+	QTextDocument* document = new QTextDocument;
+	document->setUndoRedoEnabled(false);
+
+	QTextCursor cursor(document);
+	for (qsizetype i = 0, count = m_blocks.count(); i < count; ++i) {
+		const Block& block = *m_blocks.at(i);
+
+		const QTextBlockFormat block_format = m_formats.value(block.block_format).toBlockFormat();
+		const QTextCharFormat char_format = m_formats.value(block.char_format).toCharFormat();
+		if (i > 0) {
+			cursor.insertBlock(block_format, char_format);
+		} else {
+			cursor.setBlockFormat(block_format);
+			cursor.setBlockCharFormat(char_format);
+		}
+
+		int start = 0;
+		for (const Fragment& fragment : block.fragments) {
+			cursor.insertText(block.text.mid(start, fragment.length), m_formats.value(fragment.format).toCharFormat());
+			start += fragment.length;
+		}
+	}
+
+	return document;
+}
+
+//-----------------------------------------------------------------------------
+
+QList<unsigned int> DocumentSnapshot::revisions() const
+{
+	QList<unsigned int> revisions;
+	revisions.reserve(m_blocks.count());
+	for (const QSharedPointer<const Block>& block : m_blocks) {
+		revisions.append(block->revision);
+	}
+	return revisions;
+}
+
+//-----------------------------------------------------------------------------
+
+QSharedPointer<const DocumentSnapshot::Block> DocumentSnapshot::createBlock(const QTextBlock& block, unsigned int revision)
+{
+	QSharedPointer<Block> result(new Block);
+	result->text = block.text();
+	result->revision = revision;
+	result->block_format = block.blockFormatIndex();
+	result->char_format = block.charFormatIndex();
+	for (QTextBlock::iterator i = block.begin(); !i.atEnd(); ++i) {
+		const QTextFragment fragment = i.fragment();
+		result->fragments.append({ fragment.length(), fragment.charFormatIndex() });
+	}
+	return result;
+}
+
+//-----------------------------------------------------------------------------
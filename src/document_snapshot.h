@@ -0,0 +1,51 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef FOCUSWRITER_DOCUMENT_SNAPSHOT_H
+#define FOCUSWRITER_DOCUMENT_SNAPSHOT_H
+
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QTextFormat>
+class QTextBlock;
+class QTextDocument;
+
+// Immutable copy of the text and formatting of a document that can be used from other threads
+class DocumentSnapshot
+{
+public:
+	explicit DocumentSnapshot(const QTextDocument* document, const DocumentSnapshot* previous = nullptr);
+
+	QTextDocument* createDocument() const;
+	QList<unsigned int> revisions() const;
+
+private:
+	struct Fragment
+	{
+		int length;
+		int format;
+	};
+
+	struct Block
+	{
+		QString text;
+		unsigned int revision;
+		int block_format;
+		int char_format;
+		QList<Fragment> fragments;
+	};
+
+	static QSharedPointer<const Block> createBlock(const QTextBlock& block, unsigned int revision);
+
+private:
+	QList<QSharedPointer<const Block>> m_blocks;
+	QHash<unsigned int, QSharedPointer<const Block>> m_revisions;
+	QList<QTextFormat> m_formats;
+};
+
+#endif // FOCUSWRITER_DOCUMENT_SNAPSHOT_H
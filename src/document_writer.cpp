@@ -1,28 +1,23 @@
 /*
-	SPDX-FileCopyrightText: 2012-2020 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2012-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
 
 #include "document_writer.h"
 
+#include "block_stats.h"
+#include "block_xml_cache.h"
 #include "docx_writer.h"
 #include "odt_writer.h"
 #include "rtf_writer.h"
 #include "blm_writer.h"
 #include "mtxt_writer.h"
+#include "txt_writer.h"
 
-#include <QFile>
+#include <QSaveFile>
+#include <QTextBlock>
 #include <QTextDocument>
-#include <QTextStream>
-
-#if defined(Q_OS_UNIX)
-#include <unistd.h>
-#include <errno.h>
-#elif defined(Q_OS_WIN)
-#include <windows.h>
-#include <io.h>
-#endif
 
 //-----------------------------------------------------------------------------
 
@@ -46,25 +41,54 @@ DocumentWriter::~DocumentWriter()
 
 bool DocumentWriter::write()
 {
+	// Find revisions of blocks to look up their cached XML
+	QList<unsigned int> revisions;
+	if (m_block_cache) {
+		if (!m_document && m_snapshot) {
+			revisions = m_snapshot->revisions();
+		} else if (m_document) {
+			revisions.reserve(m_document->blockCount());
+			for (QTextBlock i = m_document->begin(); i.isValid(); i = i.next()) {
+				const BlockStats* stats = static_cast<BlockStats*>(i.userData());
+				revisions.append(stats ? stats->revision() : 0);
+			}
+		}
+	}
+
+	// Rebuild document from snapshot in current thread
+	if (!m_document && m_snapshot) {
+		m_document = m_snapshot->createDocument();
+		m_snapshot.reset();
+	}
+
 	Q_ASSERT(m_document);
 	Q_ASSERT(!m_filename.isEmpty());
 
 	bool saved = false;
 
-	QFile file(m_filename);
-	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+	// Write to temporary file that replaces the original only once it is complete
+	QSaveFile file(m_filename);
+	file.setDirectWriteFallback(true);
+	if (!file.open(QIODevice::WriteOnly)) {
 		return false;
 	}
 
+	if (m_block_cache) {
+		m_block_cache->begin(m_type, revisions);
+	}
+
 	if (m_type == "odt") {
 		OdtWriter writer;
+		writer.setBlockCache(m_block_cache.data());
 		saved = writer.write(&file, m_document);
 	} else if (m_type == "fodt") {
 		OdtWriter writer;
+		writer.setBlockCache(m_block_cache.data());
 		writer.setFlatXML(true);
 		saved = writer.write(&file, m_document);
 	} else if (m_type == "docx") {
 		DocxWriter writer;
+		writer.setBlockCache(m_block_cache.data());
 		saved = writer.write(&file, m_document);
 	} else if (m_type == "rtf") {
 		file.setTextModeEnabled(true);
@@ -80,25 +104,21 @@ bool DocumentWriter::write()
 		saved = writer.write(&file, m_document);
 	} else {
 		file.setTextModeEnabled(true);
-		QTextStream stream(&file);
-		if (m_write_bom) {
-			stream.setGenerateByteOrderMark(true);
-		}
-		stream << m_document->toPlainText();
-		saved = stream.status() == QTextStream::Ok;
+		TxtWriter writer;
+		writer.setWriteByteOrderMark(m_write_bom);
+		saved = writer.write(&file, m_document);
 	}
 
-	saved &= file.flush();
-#if defined(Q_OS_UNIX)
-	int ret;
-	do {
-		ret = fsync(file.handle());
-	} while ((ret == -1) && (errno == EINTR));
-	saved &= (ret == 0);
-#elif defined(Q_OS_WIN)
-	saved &= (FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()))) != 0);
-#endif
-	file.close();
+	// QSaveFile::commit() flushes and syncs the file to disk before renaming it
+	if (saved) {
+		saved = file.commit();
+	} else {
+		file.cancelWriting();
+	}
+
+	if (m_block_cache) {
+		m_block_cache->finish();
+	}
 
 	return saved;
 }
@@ -7,6 +7,10 @@
 #ifndef FOCUSWRITER_DOCUMENT_WRITER_H
 #define FOCUSWRITER_DOCUMENT_WRITER_H
 
+#include "document_snapshot.h"
+class BlockXmlCache;
+
+#include <QSharedPointer>
 #include <QString>
 class QTextDocument;
 
@@ -16,8 +20,10 @@ public:
 	explicit DocumentWriter();
 	~DocumentWriter();
 
+	void setBlockCache(QSharedPointer<BlockXmlCache> cache);
 	void setDocument(const QTextDocument* document);
 	void setFileName(const QString& filename);
+	void setSnapshot(QSharedPointer<const DocumentSnapshot> snapshot);
 	void setType(const QString& type);
 	void setWriteByteOrderMark(bool write_bom);
 
@@ -27,9 +33,16 @@ private:
 	QString m_filename;
 	QString m_type;
 	const QTextDocument* m_document;
+	QSharedPointer<const DocumentSnapshot> m_snapshot;
+	QSharedPointer<BlockXmlCache> m_block_cache;
 	bool m_write_bom;
 };
 
+inline void DocumentWriter::setBlockCache(QSharedPointer<BlockXmlCache> cache)
+{
+	m_block_cache = cache;
+}
+
 inline void DocumentWriter::setDocument(const QTextDocument* document)
 {
 	m_document = document;
@@ -40,6 +53,11 @@ inline void DocumentWriter::setFileName(const QString& filename)
 	m_filename = filename;
 }
 
+inline void DocumentWriter::setSnapshot(QSharedPointer<const DocumentSnapshot> snapshot)
+{
+	m_snapshot = snapshot;
+}
+
 inline void DocumentWriter::setType(const QString& type)
 {
 	m_type = type.toLower();
@@ -27,8 +27,8 @@ void BlmReader::readData(QIODevice* device)
     QTextStream stream(device);
     stream.setEncoding(QStringConverter::Utf8);
 
-    QString header = stream.readLine();
-    if (!header.startsWith("::BLM1::"))
+    QString line = stream.readLine();
+    if (!line.startsWith("::BLM1::"))
         return;
 
     m_cursor.beginEditBlock();
@@ -36,8 +36,9 @@ void BlmReader::readData(QIODevice* device)
     m_baselineBlockFormat = m_cursor.blockFormat();
     m_inline = m_cursor.charFormat();
 
-    while (!stream.atEnd()) {
-        processLine(stream.readLine());
+    while (stream.readLineInto(&line) && !isCancelled()) {
+        processLine(line);
+        setProgress(device->pos(), device->size());
     }
 
     m_cursor.endEditBlock();
@@ -45,7 +46,7 @@ void BlmReader::readData(QIODevice* device)
 
 //------------------------------------------------------------
 
-void BlmReader::processLine(const QString& line)
+void BlmReader::processLine(QStringView line)
 {
     /* ===== Empty line → real newline ===== */
 
@@ -89,17 +90,16 @@ void BlmReader::processLine(const QString& line)
         if (!buffer.isEmpty()) {
             ensureBlock();
             m_cursor.insertText(buffer, m_inline);
-            buffer.clear();
+            buffer.resize(0);
         }
     };
 
-    int i = 0;
+    qsizetype i = 0;
     while (i < line.size()) {
 
         /* ===== Page break: \{p}  (OPTION B) ===== */
 
-        if (i + 4 <= line.size() &&
-            line.mid(i, 4) == "\\{p}") {
+        if (line.sliced(i).startsWith(u"\\{p}")) {
 
             flush();
 
@@ -144,16 +144,11 @@ void BlmReader::processLine(const QString& line)
             }
 
             // escape normal
-            while (i < line.size()) {
-                if (i + 2 < line.size() &&
-                    line.at(i) == '\\' &&
-                    line.at(i + 1) == 't' &&
-                    line.at(i + 2) == '}') {
-                    i += 3;
-                    break;
-                }
-                buffer += line.at(i++);
-            }
+            qsizetype end = line.indexOf(u"\\t}", i);
+            if (end == -1)
+                end = line.size();
+            buffer += line.sliced(i, end - i);
+            i = qMin(end + 3, line.size());
 
             continue;
         }
@@ -168,7 +163,7 @@ void BlmReader::processLine(const QString& line)
 
             if (t == 'l' || t == 'r' || t == 'c' || t == 'j') {
 
-                int j = i + 3;
+                qsizetype j = i + 3;
                 int indent = 0;
                 bool hasDigits = false;
 
@@ -283,7 +278,7 @@ void BlmReader::processLine(const QString& line)
             if (t == '_')
                 f.setVerticalAlignment(QTextCharFormat::AlignSubScript);
 
-            m_inline = f;
+            m_inline = internFormat(f);
 
             i += 3;
             continue;
@@ -310,8 +305,26 @@ void BlmReader::processLine(const QString& line)
 
         /* ===== Plain text ===== */
 
-        buffer += line.at(i++);
+        // Markup always starts with a backslash, so copy everything before the next one
+        qsizetype end = line.indexOf(u'\\', i + 1);
+        if (end == -1)
+            end = line.size();
+        buffer += line.sliced(i, end - i);
+        i = end;
     }
 
     flush();
 }
+
+//------------------------------------------------------------
+
+QTextCharFormat BlmReader::internFormat(const QTextCharFormat& format)
+{
+    // Reuse equal formats so that the document does not have to hash copies of them
+    for (const QTextCharFormat& interned : std::as_const(m_formats)) {
+        if (interned == format)
+            return interned;
+    }
+    m_formats.append(format);
+    return format;
+}
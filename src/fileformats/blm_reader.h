@@ -7,7 +7,9 @@
 
 #include "format_reader.h"
 
+#include <QList>
 #include <QStack>
+#include <QStringView>
 #include <QTextCharFormat>
 
 class BlmReader : public FormatReader
@@ -30,6 +32,7 @@ private:
     // ---- inline state ----
     QTextCharFormat m_inline;
     QStack<QTextCharFormat> m_inlineStack;
+    QList<QTextCharFormat> m_formats;
 
     // ---- baseline ----
     QTextBlockFormat m_baselineBlockFormat;
@@ -38,5 +41,6 @@ private:
     bool m_usedInitialBlock = false;
     bool m_ignoredAlignment = false;
 
-    void processLine(const QString& line);
+    void processLine(QStringView line);
+    QTextCharFormat internFormat(const QTextCharFormat& format);
 };
@@ -5,6 +5,8 @@
 
 #include "blm_writer.h"
 
+#include "text_writer.h"
+
 #include <QTextBlock>
 #include <QTextBlockFormat>
 #include <QTextFragment>
@@ -36,7 +38,7 @@ static bool isSub(const QTextCharFormat& f)      { return f.verticalAlignment()
 // Literal-safe write (escapes canónicos)
 //------------------------------------------------------------
 
-static void writeSafe(QIODevice* out, const QString& text)
+static void writeSafe(TextWriter& out, const QString& text)
 {
     // Forma canónica \{t\t} se respeta y no se re-escapa
     static const QRegularExpression rx(
@@ -50,40 +52,42 @@ static void writeSafe(QIODevice* out, const QString& text)
         auto m = it.next();
 
         if (m.capturedStart() > pos)
-            out->write(text.mid(pos, m.capturedStart() - pos).toUtf8());
+            out.write(QStringView(text).mid(pos, m.capturedStart() - pos));
 
-        const QString tok = m.captured();
+        const QStringView tok = m.capturedView();
 
         // forma canónica: copiar tal cual
-        if (tok == "\\{t\\t}") {
-            out->write(tok.toUtf8());
+        if (tok == QLatin1String("\\{t\\t}")) {
+            out.write(tok);
         }
         // literal "\t}"
-        else if (tok == "\\t}") {
-            out->write("\\{t\\t}");
+        else if (tok == QLatin1String("\\t}")) {
+            out.write("\\{t\\t}");
         }
         // resto de marcas
         else {
-            out->write("\\{t");
-            out->write(tok.toUtf8());
-            out->write("\\t}");
+            out.write("\\{t");
+            out.write(tok);
+            out.write("\\t}");
         }
 
         pos = m.capturedEnd();
     }
 
     if (pos < text.size())
-        out->write(text.mid(pos).toUtf8());
+        out.write(QStringView(text).mid(pos));
 }
 
 //------------------------------------------------------------
 
-bool BlmWriter::write(QIODevice* out, const QTextDocument* doc)
+bool BlmWriter::write(QIODevice* device, const QTextDocument* doc)
 {
-    if (!out || !doc)
+    if (!device || !doc)
         return false;
 
-    out->write("::BLM1::\n");
+    TextWriter out(device);
+
+    out.write("::BLM1::\n");
 
     QTextCharFormat prevChar;
     QStack<char> inlineStack;
@@ -96,7 +100,7 @@ bool BlmWriter::write(QIODevice* out, const QTextDocument* doc)
 
         // ---------- Empty block ----------
         if (plain.trimmed().isEmpty()) {
-            out->write("\n");
+            out.write("\n");
             prevChar = QTextCharFormat();
             continue;
         }
@@ -130,20 +134,20 @@ bool BlmWriter::write(QIODevice* out, const QTextDocument* doc)
 
         // ---------- Block open ----------
         if (!isLeft || indent > 0) {
-            out->write("\\{");
+            out.write("\\{");
             if (!isLeft)
-                out->write(alignTok);
+                out.write(alignTok);
             else
-                out->write("l");
+                out.write("l");
 
             if (indent > 0)
-                out->write(QByteArray::number(indent));
+                out.write(QByteArray::number(indent));
 
-            out->write("\n");
+            out.write("\n");
         }
 
         if (hasHeading)
-            out->write("\\{h" + QByteArray::number(heading) + "\n");
+            out.write("\\{h" + QByteArray::number(heading) + "\n");
 
         // ---------- Text ----------
         for (QTextBlock::iterator it = block.begin();
@@ -168,7 +172,7 @@ bool BlmWriter::write(QIODevice* out, const QTextDocument* doc)
 
                 if (close) {
                     inlineStack.pop();
-                    out->write("\\" + QByteArray(1, t) + "}");
+                    out.write("\\" + QByteArray(1, t) + "}");
                 }
             }
 
@@ -185,7 +189,7 @@ bool BlmWriter::write(QIODevice* out, const QTextDocument* doc)
 
                 if (open) {
                     inlineStack.push(t);
-                    out->write("\\{" + QByteArray(1, t));
+                    out.write("\\{" + QByteArray(1, t));
                 }
             }
 
@@ -195,22 +199,22 @@ bool BlmWriter::write(QIODevice* out, const QTextDocument* doc)
 
         // ---------- Close inline ----------
         while (!inlineStack.isEmpty())
-            out->write("\\" + QByteArray(1, inlineStack.pop()) + "}");
+            out.write("\\" + QByteArray(1, inlineStack.pop()) + "}");
 
-        out->write("\n");
+        out.write("\n");
 
         // ---------- Block close ----------
         if (hasHeading)
-            out->write("\\h" + QByteArray::number(heading) + "}\n");
+            out.write("\\h" + QByteArray::number(heading) + "}\n");
 
         if (!isLeft || indent > 0) {
-            out->write("\\");
-            out->write(!isLeft ? alignTok : QByteArray("l"));
-            out->write("}\n");
+            out.write("\\");
+            out.write(!isLeft ? alignTok : QByteArray("l"));
+            out.write("}\n");
         }
 
         prevChar = QTextCharFormat();
     }
 
-    return true;
+    return out.flush();
 }
@@ -11,5 +11,5 @@
 class BlmWriter
 {
 public:
-    bool write(QIODevice* out, const QTextDocument* doc);
+    bool write(QIODevice* device, const QTextDocument* doc);
 };
@@ -0,0 +1,65 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "block_xml_cache.h"
+
+//-----------------------------------------------------------------------------
+
+void BlockXmlCache::begin(const QString& type, const QList<unsigned int>& revisions)
+{
+	// Paragraphs are serialized differently by each file format
+	if (m_type != type) {
+		m_entries.clear();
+		m_type = type;
+	}
+	m_revisions = revisions;
+}
+
+//-----------------------------------------------------------------------------
+
+void BlockXmlCache::finish()
+{
+	// Discard paragraphs that no longer exist
+	for (auto i = m_entries.begin(); i != m_entries.end();) {
+		if (i->used) {
+			i->used = false;
+			++i;
+		} else {
+			i = m_entries.erase(i);
+		}
+	}
+	m_revisions.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+QByteArray BlockXmlCache::find(int block, const QStringList& styles)
+{
+	const unsigned int revision = m_revisions.value(block);
+	if (!revision) {
+		return QByteArray();
+	}
+
+	const auto i = m_entries.find(revision);
+	if ((i == m_entries.end()) || (i->styles != styles)) {
+		return QByteArray();
+	}
+
+	i->used = true;
+	return i->xml;
+}
+
+//-----------------------------------------------------------------------------
+
+void BlockXmlCache::insert(int block, const QStringList& styles, const QByteArray& xml)
+{
+	const unsigned int revision = m_revisions.value(block);
+	if (revision) {
+		m_entries.insert(revision, { styles, xml, true });
+	}
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,39 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef FOCUSWRITER_BLOCK_XML_CACHE_H
+#define FOCUSWRITER_BLOCK_XML_CACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// Serialized XML of paragraphs that can be reused by later writes of the same document
+class BlockXmlCache
+{
+public:
+	void begin(const QString& type, const QList<unsigned int>& revisions);
+	void finish();
+
+	QByteArray find(int block, const QStringList& styles);
+	void insert(int block, const QStringList& styles, const QByteArray& xml);
+
+private:
+	struct Entry
+	{
+		QStringList styles;
+		QByteArray xml;
+		bool used;
+	};
+
+	QString m_type;
+	QList<unsigned int> m_revisions;
+	QHash<unsigned int, Entry> m_entries;
+};
+
+#endif // FOCUSWRITER_BLOCK_XML_CACHE_H
@@ -41,7 +41,8 @@ static bool readBool(QStringView value)
 //-----------------------------------------------------------------------------
 
 DocxReader::DocxReader()
-	: m_in_block(false)
+	: m_xml_size(0)
+	, m_in_block(false)
 {
 	m_xml.setNamespaceProcessing(false);
 }
@@ -67,17 +68,25 @@ void DocxReader::readData(QIODevice* device)
 	if (zip.isReadable()) {
 		static const QString files[] = { QStringLiteral("word/styles.xml"), QStringLiteral("word/document.xml") };
 		for (int i = 0; i < 2; ++i) {
-			const QByteArray data = zip.fileData(files[i]);
-			if (data.isEmpty()) {
+			QIODevice* data = zip.fileDevice(files[i]);
+			if (!data) {
+				continue;
+			} else if (!data->size()) {
+				delete data;
 				continue;
 			}
-			m_xml.addData(data);
+			m_xml.setDevice(data);
+			m_xml_size = data->size();
 			readContent();
-			if (m_xml.hasError()) {
+			const bool error = m_xml.hasError();
+			if (error) {
 				m_error = m_xml.errorString();
-				break;
 			}
 			m_xml.clear();
+			delete data;
+			if (error) {
+				break;
+			}
 		}
 	} else {
 		m_error = tr("Unable to open archive.");
@@ -242,6 +251,12 @@ void DocxReader::readDocument()
 void DocxReader::readBody()
 {
 	while (m_xml.readNextStartElement()) {
+		if (isCancelled()) {
+			m_xml.raiseError();
+			break;
+		}
+		setProgress(m_xml.characterOffset(), m_xml_size);
+
 		if (m_xml.qualifiedName() == QLatin1String("w:p")) {
 			readParagraph();
 		} else {
@@ -62,6 +62,7 @@ private:
 
 private:
 	QXmlStreamReader m_xml;
+	qint64 m_xml_size;
 
 	QHash<QString, Style> m_styles;
 	QStack<Style> m_previous_styles;
@@ -6,6 +6,8 @@
 
 #include "docx_writer.h"
 
+#include "block_xml_cache.h"
+
 #include <QBuffer>
 #include <QTextBlock>
 #include <QTextBlockFormat>
@@ -16,12 +18,20 @@
 //-----------------------------------------------------------------------------
 
 DocxWriter::DocxWriter()
-	: m_strict(false)
+	: m_block_cache(nullptr)
+	, m_strict(false)
 {
 }
 
 //-----------------------------------------------------------------------------
 
+void DocxWriter::setBlockCache(BlockXmlCache* cache)
+{
+	m_block_cache = cache;
+}
+
+//-----------------------------------------------------------------------------
+
 void DocxWriter::setStrict(bool strict)
 {
 	m_strict = strict;
@@ -48,8 +58,9 @@ bool DocxWriter::write(QIODevice* device, const QTextDocument* document)
 		"<Relationship Target=\"styles.xml\" Id=\"docRId0\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/styles\"/>"
 		"</Relationships>");
 
-	zip.addFile(QStringLiteral("word/document.xml"),
-		writeDocument(document));
+	QIODevice* content = zip.fileDevice(QStringLiteral("word/document.xml"));
+	writeDocument(content, document);
+	delete content;
 
 	zip.addFile(QStringLiteral("word/styles.xml"),
 		"<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
@@ -150,29 +161,44 @@ bool DocxWriter::write(QIODevice* device, const QTextDocument* document)
 
 //-----------------------------------------------------------------------------
 
-QByteArray DocxWriter::writeDocument(const QTextDocument* document)
+void DocxWriter::writeDocument(QIODevice* device, const QTextDocument* document)
 {
-	QByteArray data;
-	QBuffer buffer(&data);
-	buffer.open(QIODevice::WriteOnly);
-	m_xml.setDevice(&buffer);
+	m_xml.setDevice(device);
 	m_xml.writeNamespace(QStringLiteral("http://schemas.openxmlformats.org/wordprocessingml/2006/main"), QStringLiteral("w"));
 	m_xml.writeStartDocument(QStringLiteral("1.0"), true);
 
 	m_xml.writeStartElement(QStringLiteral("w:document"));
 	m_xml.writeStartElement(QStringLiteral("w:body"));
 
+	// Write paragraphs directly to device so that unchanged ones can be copied from cache
+	m_xml.writeCharacters(QString());
 	for (QTextBlock block = document->begin(); block.isValid(); block = block.next()) {
-		writeParagraph(block);
+		QByteArray xml;
+		if (m_block_cache) {
+			xml = m_block_cache->find(block.blockNumber(), QStringList());
+		}
+
+		if (xml.isNull()) {
+			QBuffer buffer(&xml);
+			buffer.open(QIODevice::WriteOnly);
+			m_xml.setDevice(&buffer);
+			writeParagraph(block);
+			m_xml.setDevice(device);
+			buffer.close();
+
+			if (m_block_cache) {
+				m_block_cache->insert(block.blockNumber(), QStringList(), xml);
+			}
+		}
+
+		device->write(xml);
 	}
 
 	m_xml.writeEndElement();
 	m_xml.writeEndElement();
 
 	m_xml.writeEndDocument();
-	buffer.close();
-
-	return data;
+	m_xml.setDevice(nullptr);
 }
 
 //-----------------------------------------------------------------------------
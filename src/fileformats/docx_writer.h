@@ -10,6 +10,7 @@
 #include <QCoreApplication>
 #include <QString>
 #include <QXmlStreamWriter>
+class BlockXmlCache;
 class QIODevice;
 class QTextBlock;
 class QTextBlockFormat;
@@ -28,11 +29,12 @@ public:
 		return m_error;
 	}
 
+	void setBlockCache(BlockXmlCache* cache);
 	void setStrict(bool strict);
 	bool write(QIODevice* device, const QTextDocument* document);
 
 private:
-	QByteArray writeDocument(const QTextDocument* document);
+	void writeDocument(QIODevice* device, const QTextDocument* document);
 	void writeParagraph(const QTextBlock& block);
 	void writeText(const QString& text, int start, int end);
 	void writeParagraphProperties(const QTextBlockFormat& block_format, const QTextCharFormat& char_format);
@@ -42,6 +44,7 @@ private:
 
 private:
 	QXmlStreamWriter m_xml;
+	BlockXmlCache* m_block_cache;
 	bool m_strict;
 	QString m_error;
 };
@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2013-2015 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2013-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -13,53 +13,129 @@
 #include "mtxt_reader.h"
 #include "txt_reader.h"
 
+#include <QDateTime>
+#include <QFileDevice>
+#include <QHash>
+#include <QMutex>
+
 //-----------------------------------------------------------------------------
 
-FormatReader* FormatManager::createReader(QIODevice* device, const QString& type)
+namespace
 {
-	FormatReader* reader = nullptr;
 
-	// Try file extension first
-	if (type == "odt" || type == "fodt") {
-		if (OdtReader::canRead(device)) {
-			reader = new OdtReader;
-		}
-	} else if (type == "docx") {
-		if (DocxReader::canRead(device)) {
-			reader = new DocxReader;
-		}
-	} else if (type == "rtf") {
-		if (RtfReader::canRead(device)) {
-			reader = new RtfReader;
+enum FileContents
+{
+	TextContents,
+	OdtPackageContents,
+	OdtFlatContents,
+	ZipContents,
+	RtfContents,
+	BlmContents,
+	MtxtContents
+};
+
+// Size of header that is enough to recognize every supported format
+const qint64 header_size = 512;
+
+// Remember what files contain so that reopening them does not need to read them again
+struct SniffedFile
+{
+	QDateTime modified;
+	qint64 size;
+	FileContents contents;
+};
+QHash<QString, SniffedFile> f_sniffed_files;
+QMutex f_sniffed_files_mutex;
+const qsizetype max_sniffed_files = 1000;
+
+FileContents sniffContents(const QByteArray& header)
+{
+	if (header.startsWith("PK\x03\x04")) {
+		// Check for uncompressed mimetype entry that starts OpenDocument packages
+		if (header.mid(30, 47) == "mimetypeapplication/vnd.oasis.opendocument.text") {
+			return OdtPackageContents;
 		}
-	} else if (type == "blm") {
-		if (BlmReader::canRead(device)) {
-			reader = new BlmReader;
+		return ZipContents;
+	} else if (header.startsWith("{\\rtf")) {
+		return RtfContents;
+	} else if (header.startsWith("::BLM1::")) {
+		return BlmContents;
+	} else if (header.startsWith("/*MTXT1*/")) {
+		return MtxtContents;
+	}
+
+	// Check for flat OpenDocument XML
+	const QByteArray data = header.trimmed();
+	if (data.startsWith("<?xml")) {
+		const qsizetype index = data.indexOf("?>");
+		if (index != -1) {
+			const qsizetype tagindex = data.indexOf("<", index);
+			if ((tagindex != -1) && (data.indexOf("<office:document", index) == tagindex)) {
+				return OdtFlatContents;
+			}
 		}
-	} else if (type == "mtxt") {
-		if (MtxtReader::canRead(device)) {
-			reader = new MtxtReader;
+	}
+
+	return TextContents;
+}
+
+FileContents findContents(QIODevice* device)
+{
+	// Check for file that was already sniffed and has not changed since
+	QFileDevice* file = qobject_cast<QFileDevice*>(device);
+	QString filename;
+	QDateTime modified;
+	qint64 size = 0;
+	if (file && !file->fileName().isEmpty()) {
+		filename = file->fileName();
+		modified = file->fileTime(QFileDevice::FileModificationTime);
+		size = file->size();
+
+		QMutexLocker locker(&f_sniffed_files_mutex);
+		const auto i = f_sniffed_files.constFind(filename);
+		if ((i != f_sniffed_files.constEnd()) && modified.isValid() && (i->modified == modified) && (i->size == size)) {
+			return i->contents;
 		}
 	}
 
-	// Fall back to finding format from contents
-	if (!reader) {
-		if (OdtReader::canRead(device)) {
-			reader = new OdtReader;
-		} else if (DocxReader::canRead(device)) {
-			reader = new DocxReader;
-		} else if (RtfReader::canRead(device)) {
-			reader = new RtfReader;
-		} else if (BlmReader::canRead(device)) {
-			reader = new BlmReader;
-		} else if (MtxtReader::canRead(device)) {
-			reader = new MtxtReader;
-		} else {
-			reader = new TxtReader;
+	// Read header once and classify it
+	const FileContents contents = sniffContents(device->peek(header_size));
+
+	if (!filename.isEmpty() && modified.isValid()) {
+		QMutexLocker locker(&f_sniffed_files_mutex);
+		if (f_sniffed_files.size() >= max_sniffed_files) {
+			f_sniffed_files.clear();
 		}
+		f_sniffed_files.insert(filename, { modified, size, contents });
 	}
 
-	return reader;
+	return contents;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+FormatReader* FormatManager::createReader(QIODevice* device, const QString& type)
+{
+	switch (findContents(device)) {
+	case OdtPackageContents:
+		// Any archive is tried as Office Open XML when named as such
+		return (type == "docx") ? static_cast<FormatReader*>(new DocxReader) : new OdtReader;
+	case OdtFlatContents:
+		return new OdtReader;
+	case ZipContents:
+		return new DocxReader;
+	case RtfContents:
+		return new RtfReader;
+	case BlmContents:
+		return new BlmReader;
+	case MtxtContents:
+		return new MtxtReader;
+	case TextContents:
+	default:
+		return new TxtReader;
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -12,6 +12,8 @@
 class QIODevice;
 class QTextDocument;
 
+#include <atomic>
+
 class FormatReader
 {
 public:
@@ -29,6 +31,18 @@ public:
 		return !m_error.isEmpty();
 	}
 
+	// Safe to call from other threads while reading
+	void cancel()
+	{
+		m_cancelled = true;
+	}
+
+	// Safe to call from other threads while reading
+	int progress() const
+	{
+		return m_progress;
+	}
+
 	void read(QIODevice* device, QTextDocument* document)
 	{
 		m_cursor = QTextCursor(document);
@@ -47,12 +61,29 @@ public:
 		return Type;
 	}
 
+protected:
+	bool isCancelled() const
+	{
+		return m_cancelled;
+	}
+
+	void setProgress(qint64 value, qint64 total)
+	{
+		if (total > 0) {
+			m_progress = int(qBound(qint64(0), (value * 100) / total, qint64(100)));
+		}
+	}
+
 protected:
 	QTextCursor m_cursor;
 	QString m_error;
 
 private:
 	virtual void readData(QIODevice* device) = 0;
+
+private:
+	std::atomic<bool> m_cancelled = false;
+	std::atomic<int> m_progress = 0;
 };
 
 #endif // FOCUSWRITER_FORMAT_READER_H
@@ -8,6 +8,32 @@
 #include <QTextStream>
 #include <QTextBlockFormat>
 #include <QFont>
+#include <QList>
+#include <QStringView>
+
+//-----------------------------------------------------------------------------
+
+namespace {
+
+enum StyleFlag {
+    BoldStyle = 0x1,
+    ItalicStyle = 0x2,
+    UnderlineStyle = 0x4,
+    StrikeOutStyle = 0x8,
+    StyleCount = 0x10
+};
+
+struct Run {
+    qsizetype length;
+    int style;
+};
+
+inline bool isMarkup(QChar c)
+{
+    return c == u'\\' || c == u'*' || c == u'_' || c == u'~' || c == u'<';
+}
+
+}
 
 //-----------------------------------------------------------------------------
 
@@ -36,10 +62,28 @@ void MtxtReader::readData(QIODevice* device)
     // 🔑 Capturar bloque base limpio (tema, sangrado, etc.)
     QTextBlockFormat baseBlock = m_cursor.blockFormat();
 
+    // Share one format per combination of styles
+    QTextCharFormat formats[StyleCount];
+    for (int style = 0; style < StyleCount; ++style) {
+        if (style & BoldStyle)
+            formats[style].setFontWeight(QFont::Bold);
+        if (style & ItalicStyle)
+            formats[style].setFontItalic(true);
+        if (style & UnderlineStyle)
+            formats[style].setFontUnderline(true);
+        if (style & StrikeOutStyle)
+            formats[style].setFontStrikeOut(true);
+    }
+
     bool first = true;
 
-    while (!stream.atEnd()) {
-        QString line = stream.readLine();
+    QString buffer;
+    QString text;
+    QList<Run> runs;
+
+    while (stream.readLineInto(&buffer) && !isCancelled()) {
+        const QStringView line(buffer);
+        setProgress(device->pos(), device->size());
 
         if (!first) {
             // 🔑 Crear SIEMPRE desde el bloque base limpio
@@ -47,79 +91,98 @@ void MtxtReader::readData(QIODevice* device)
         }
         first = false;
 
-        QTextCharFormat current;
-        QString buffer;
-
-        bool centered = false;
+        // Split line into runs of text that share a style
+        text.resize(0);
+        runs.resize(0);
+        int style = 0;
+        qsizetype runStart = 0;
 
-        auto flush = [&]() {
-            if (!buffer.isEmpty()) {
-                m_cursor.insertText(buffer, current);
-                buffer.clear();
+        auto toggle = [&](int flag) {
+            if (text.size() > runStart) {
+                runs.append({ text.size() - runStart, style });
+                runStart = text.size();
             }
+            style ^= flag;
         };
 
-        for (int i = 0; i < line.length(); ++i) {
-            const QChar c = line.at(i);
+        const qsizetype length = line.size();
+        qsizetype i = 0;
 
-            // Escape
-            if (c == '\\' && i + 1 < line.length()) {
-                buffer += line.at(++i);
+        // Centered line start
+        bool centered = false;
+        if (length && line.at(0) == u'>') {
+            QTextBlockFormat bf = m_cursor.blockFormat();
+            bf.setAlignment(Qt::AlignCenter);
+            m_cursor.mergeBlockFormat(bf);
+            centered = true;
+            i = 1;
+        }
+
+        while (i < length) {
+            // Plain text
+            qsizetype end = i;
+            while (end < length && !isMarkup(line.at(end)))
+                ++end;
+            if (end > i) {
+                text.append(line.sliced(i, end - i));
+                i = end;
                 continue;
             }
 
-            // Centered line start
-            if (i == 0 && c == '>') {
-                QTextBlockFormat bf = m_cursor.blockFormat();
-                bf.setAlignment(Qt::AlignCenter);
-                m_cursor.mergeBlockFormat(bf);
-                centered = true;
+            const QChar c = line.at(i);
+
+            // Escape
+            if (c == u'\\' && i + 1 < length) {
+                text.append(line.at(i + 1));
+                i += 2;
                 continue;
             }
 
             // Centered line end
-            if (centered && c == '<' && i == line.length() - 1)
+            if (centered && c == u'<' && i == length - 1) {
+                ++i;
                 continue;
+            }
 
             // Inline styles
-            if (c == '*' && line.mid(i, 3) == "***") {
-                flush();
-                current.setFontWeight(
-                    current.fontWeight() == QFont::Bold ? QFont::Normal : QFont::Bold
-                );
-                current.setFontItalic(!current.fontItalic());
-                i += 2;
+            const QStringView rest = line.sliced(i);
+            if (rest.startsWith(u"***")) {
+                toggle(BoldStyle | ItalicStyle);
+                i += 3;
                 continue;
             }
-            if (c == '*' && line.mid(i, 2) == "**") {
-                flush();
-                current.setFontWeight(
-                    current.fontWeight() == QFont::Bold ? QFont::Normal : QFont::Bold
-                );
-                i += 1;
+            if (rest.startsWith(u"**")) {
+                toggle(BoldStyle);
+                i += 2;
                 continue;
             }
-            if (c == '*') {
-                flush();
-                current.setFontItalic(!current.fontItalic());
+            if (c == u'*') {
+                toggle(ItalicStyle);
+                ++i;
                 continue;
             }
-            if (c == '_') {
-                flush();
-                current.setFontUnderline(!current.fontUnderline());
+            if (c == u'_') {
+                toggle(UnderlineStyle);
+                ++i;
                 continue;
             }
-            if (c == '~' && line.mid(i, 2) == "~~") {
-                flush();
-                current.setFontStrikeOut(!current.fontStrikeOut());
-                i += 1;
+            if (rest.startsWith(u"~~")) {
+                toggle(StrikeOutStyle);
+                i += 2;
                 continue;
             }
 
-            buffer += c;
+            text.append(c);
+            ++i;
         }
+        toggle(0);
 
-        flush();
+        // Insert one piece of text per run
+        qsizetype position = 0;
+        for (const Run& run : std::as_const(runs)) {
+            m_cursor.insertText(text.mid(position, run.length), formats[run.style]);
+            position += run.length;
+        }
     }
 
     m_cursor.endEditBlock();
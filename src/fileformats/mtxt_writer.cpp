@@ -6,6 +6,8 @@
 
 #include "mtxt_writer.h"
 
+#include "text_writer.h"
+
 #include <QTextBlock>
 #include <QTextCharFormat>
 #include <QTextDocument>
@@ -33,13 +35,13 @@ static StyleState getState(const QTextCharFormat& f)
 
 //-----------------------------------------------------------------------------
 
-static void emitStyle(QIODevice* d, const StyleState& from, const StyleState& to)
+static void emitStyle(TextWriter& d, const StyleState& from, const StyleState& to)
 {
     auto close = [&](bool f, bool t, const char* m){
-        if (f && !t) d->write(m);
+        if (f && !t) d.write(m);
     };
     auto open = [&](bool f, bool t, const char* m){
-        if (!f && t) d->write(m);
+        if (!f && t) d.write(m);
     };
 
     // Close in reverse nesting order
@@ -57,37 +59,43 @@ static void emitStyle(QIODevice* d, const StyleState& from, const StyleState& to
 
 //-----------------------------------------------------------------------------
 
-static QString escape(const QString& s, bool inStrike)
+static void writeEscaped(TextWriter& out, const QString& s, bool inStrike)
 {
-    QString out;
+    // Write unescaped runs directly instead of building a copy of the text
+    int start = 0;
     for (int i = 0; i < s.length(); ++i) {
         const QChar c = s.at(i);
 
         if (!inStrike && c == '~' && i + 1 < s.length() && s.at(i+1) == '~') {
-            out += "\\~~";
+            out.write(QStringView(s).mid(start, i - start));
+            out.write("\\~~");
             ++i;
+            start = i + 1;
             continue;
         }
 
-        if (c == '*' || c == '_' || c == '>' || c == '<' || c == '\\')
-            out += '\\';
-
-        out += c;
+        if (c == '*' || c == '_' || c == '>' || c == '<' || c == '\\') {
+            out.write(QStringView(s).mid(start, i - start));
+            out.write("\\");
+            start = i;
+        }
     }
-    return out;
+    out.write(QStringView(s).mid(start));
 }
 
 //-----------------------------------------------------------------------------
 
 bool MtxtWriter::write(QIODevice* device, const QTextDocument* document)
 {
-    device->write("/*MTXT1*/\n");
+    TextWriter out(device);
+
+    out.write("/*MTXT1*/\n");
 
     for (QTextBlock block = document->begin(); block.isValid(); block = block.next()) {
 
         QTextBlockFormat bf = block.blockFormat();
         if (bf.alignment() == Qt::AlignCenter)
-            device->write(">");
+            out.write(">");
 
         StyleState current;
 
@@ -95,18 +103,18 @@ bool MtxtWriter::write(QIODevice* device, const QTextDocument* document)
             QTextFragment frag = it.fragment();
             StyleState next = getState(frag.charFormat());
 
-            emitStyle(device, current, next);
-            device->write(escape(frag.text(), current.strike).toUtf8());
+            emitStyle(out, current, next);
+            writeEscaped(out, frag.text(), current.strike);
             current = next;
         }
 
-        emitStyle(device, current, StyleState());
+        emitStyle(out, current, StyleState());
 
         if (bf.alignment() == Qt::AlignCenter)
-            device->write("<");
+            out.write("<");
 
-        device->write("\n");
+        out.write("\n");
     }
 
-    return true;
+    return out.flush();
 }
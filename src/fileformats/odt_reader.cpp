@@ -15,7 +15,8 @@
 //-----------------------------------------------------------------------------
 
 OdtReader::OdtReader()
-	: m_in_block(true)
+	: m_xml_size(0)
+	, m_in_block(true)
 {
 	m_xml.setNamespaceProcessing(false);
 }
@@ -75,17 +76,25 @@ void OdtReader::readDataCompressed(QIODevice* device)
 	if (zip.isReadable()) {
 		static const QString files[] = { QStringLiteral("styles.xml"), QStringLiteral("content.xml") };
 		for (int i = 0; i < 2; ++i) {
-			const QByteArray data = zip.fileData(files[i]);
-			if (data.isEmpty()) {
+			QIODevice* data = zip.fileDevice(files[i]);
+			if (!data) {
+				continue;
+			} else if (!data->size()) {
+				delete data;
 				continue;
 			}
-			m_xml.addData(data);
+			m_xml.setDevice(data);
+			m_xml_size = data->size();
 			readDocument();
-			if (m_xml.hasError()) {
+			const bool error = m_xml.hasError();
+			if (error) {
 				m_error = m_xml.errorString();
-				break;
 			}
 			m_xml.clear();
+			delete data;
+			if (error) {
+				break;
+			}
 		}
 	} else {
 		m_error = tr("Unable to open archive.");
@@ -100,6 +109,7 @@ void OdtReader::readDataCompressed(QIODevice* device)
 void OdtReader::readDataUncompressed(QIODevice* device)
 {
 	m_xml.setDevice(device);
+	m_xml_size = device->size();
 	readDocument();
 	if (m_xml.hasError()) {
 		m_error = m_xml.errorString();
@@ -331,6 +341,12 @@ void OdtReader::readBodyText()
 	int depth = 1;
 	while (depth && (m_xml.readNext() != QXmlStreamReader::Invalid)) {
 		if (m_xml.isStartElement()) {
+			if (isCancelled()) {
+				m_xml.raiseError();
+				break;
+			}
+			setProgress(m_xml.characterOffset(), m_xml_size);
+
 			if (m_xml.qualifiedName() == QLatin1String("text:p")) {
 				readParagraph();
 			} else if (m_xml.qualifiedName() == QLatin1String("text:h")) {
@@ -45,6 +45,7 @@ private:
 
 private:
 	QXmlStreamReader m_xml;
+	qint64 m_xml_size;
 
 	struct Style
 	{
@@ -6,6 +6,8 @@
 
 #include "odt_writer.h"
 
+#include "block_xml_cache.h"
+
 #include <QBuffer>
 #include <QTextBlock>
 #include <QTextBlockFormat>
@@ -17,8 +19,16 @@
 //-----------------------------------------------------------------------------
 
 OdtWriter::OdtWriter()
-	: m_flat(false)
+	: m_block_cache(nullptr)
+	, m_flat(false)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+void OdtWriter::setBlockCache(BlockXmlCache* cache)
 {
+	m_block_cache = cache;
 }
 
 //-----------------------------------------------------------------------------
@@ -61,11 +71,13 @@ bool OdtWriter::writeCompressed(QIODevice* device, const QTextDocument* document
 		" <manifest:file-entry manifest:full-path=\"styles.xml\" manifest:media-type=\"text/xml\"/>\n"
 		"</manifest:manifest>\n");
 
-	zip.addFile(QStringLiteral("content.xml"),
-		writeDocument(document));
+	QIODevice* content = zip.fileDevice(QStringLiteral("content.xml"));
+	writeDocument(content, document);
+	delete content;
 
-	zip.addFile(QStringLiteral("styles.xml"),
-		writeStylesDocument(document));
+	QIODevice* styles = zip.fileDevice(QStringLiteral("styles.xml"));
+	writeStylesDocument(styles, document);
+	delete styles;
 
 	zip.close();
 
@@ -102,13 +114,9 @@ bool OdtWriter::writeUncompressed(QIODevice* device, const QTextDocument* docume
 
 //-----------------------------------------------------------------------------
 
-QByteArray OdtWriter::writeDocument(const QTextDocument* document)
+void OdtWriter::writeDocument(QIODevice* device, const QTextDocument* document)
 {
-	QByteArray data;
-	QBuffer buffer(&data);
-	buffer.open(QIODevice::WriteOnly);
-
-	m_xml.setDevice(&buffer);
+	m_xml.setDevice(device);
 	m_xml.setAutoFormatting(true);
 	m_xml.setAutoFormattingIndent(1);
 
@@ -126,20 +134,14 @@ QByteArray OdtWriter::writeDocument(const QTextDocument* document)
 
 	m_xml.writeEndElement();
 	m_xml.writeEndDocument();
-
-	buffer.close();
-	return data;
+	m_xml.setDevice(nullptr);
 }
 
 //-----------------------------------------------------------------------------
 
-QByteArray OdtWriter::writeStylesDocument(const QTextDocument* document)
+void OdtWriter::writeStylesDocument(QIODevice* device, const QTextDocument* document)
 {
-	QByteArray data;
-	QBuffer buffer(&data);
-	buffer.open(QIODevice::WriteOnly);
-
-	m_xml.setDevice(&buffer);
+	m_xml.setDevice(device);
 	m_xml.setAutoFormatting(true);
 	m_xml.setAutoFormattingIndent(1);
 
@@ -155,9 +157,7 @@ QByteArray OdtWriter::writeStylesDocument(const QTextDocument* document)
 
 	m_xml.writeEndElement();
 	m_xml.writeEndDocument();
-
-	buffer.close();
-	return data;
+	m_xml.setDevice(nullptr);
 }
 
 //-----------------------------------------------------------------------------
@@ -340,75 +340,115 @@ void OdtWriter::writeBody(const QTextDocument* document)
 	m_xml.writeStartElement(QStringLiteral("office:body"));
 	m_xml.writeStartElement(QStringLiteral("office:text"));
 
+	// Write paragraphs directly to device so that unchanged ones can be copied from cache
+	m_xml.writeCharacters(QString());
+	m_xml.setAutoFormatting(false);
+	QIODevice* device = m_xml.device();
+	const QByteArray indent = QByteArray(m_xml.autoFormattingIndent(), ' ');
+	const QByteArray separator = '\n' + indent.repeated(3);
+
 	for (QTextBlock block = document->begin(); block.isValid(); block = block.next()) {
-		const int heading = block.blockFormat().headingLevel();
-		if (!heading) {
-			m_xml.writeStartElement(QStringLiteral("text:p"));
-		} else {
-			m_xml.writeStartElement(QStringLiteral("text:h"));
-			m_xml.writeAttribute(QStringLiteral("text:outline-level"), QString::number(heading));
+		QStringList styles;
+		QByteArray xml;
+		if (m_block_cache) {
+			styles.append(m_styles.value(block.blockFormatIndex()));
+			for (QTextBlock::iterator iter = block.begin(); !iter.atEnd(); ++iter) {
+				styles.append(m_styles.value(iter.fragment().charFormatIndex()));
+			}
+			xml = m_block_cache->find(block.blockNumber(), styles);
 		}
-		m_xml.writeAttribute(QStringLiteral("text:style-name"), m_styles.value(block.blockFormatIndex()));
-		m_xml.setAutoFormatting(false);
 
-		for (QTextBlock::iterator iter = block.begin(); !iter.atEnd(); ++iter) {
-			const QTextFragment fragment = iter.fragment();
-			const QString style = m_styles.value(fragment.charFormatIndex());
-			if (!style.isEmpty()) {
-				m_xml.writeStartElement(QStringLiteral("text:span"));
-				m_xml.writeAttribute(QStringLiteral("text:style-name"), style);
-			}
+		if (xml.isNull()) {
+			QBuffer buffer(&xml);
+			buffer.open(QIODevice::WriteOnly);
+			m_xml.setDevice(&buffer);
+			writeParagraph(block);
+			m_xml.setDevice(device);
+			buffer.close();
 
-			const QString text = fragment.text();
-			int start = 0;
-			int spaces = -1;
-			for (int i = 0, count = text.length(); i < count; ++i) {
-				const QChar c = text.at(i);
-				if (c.unicode() == 0x0) {
-					m_xml.writeCharacters(text.mid(start, i - start));
-					spaces = -1;
-					start = i + 1;
-				} else if (c.unicode() == 0x0009) {
-					m_xml.writeCharacters(text.mid(start, i - start));
-					m_xml.writeEmptyElement(QStringLiteral("text:tab"));
-					spaces = -1;
-					start = i + 1;
-				} else if (c.unicode() == 0x2028) {
-					m_xml.writeCharacters(text.mid(start, i - start));
-					m_xml.writeEmptyElement(QStringLiteral("text:line-break"));
-					spaces = -1;
-					start = i + 1;
-				} else if (c.unicode() == 0x0020) {
-					++spaces;
-				} else if (spaces > 0) {
-					m_xml.writeCharacters(text.mid(start, i - spaces - start));
-					m_xml.writeEmptyElement(QStringLiteral("text:s"));
-					m_xml.writeAttribute(QStringLiteral("text:c"), QString::number(spaces));
-					spaces = -1;
-					start = i;
-				} else {
-					spaces = -1;
-				}
+			if (m_block_cache) {
+				m_block_cache->insert(block.blockNumber(), styles, xml);
 			}
-			if (spaces > 0) {
-				m_xml.writeCharacters(text.mid(start, text.length() - spaces - start));
+		}
+
+		device->write(separator);
+		device->write(xml);
+	}
+
+	m_xml.writeCharacters(QString());
+	device->write('\n' + indent.repeated(2));
+	m_xml.setAutoFormatting(true);
+
+	m_xml.writeEndElement();
+	m_xml.writeEndElement();
+}
+
+//-----------------------------------------------------------------------------
+
+void OdtWriter::writeParagraph(const QTextBlock& block)
+{
+	const int heading = block.blockFormat().headingLevel();
+	if (!heading) {
+		m_xml.writeStartElement(QStringLiteral("text:p"));
+	} else {
+		m_xml.writeStartElement(QStringLiteral("text:h"));
+		m_xml.writeAttribute(QStringLiteral("text:outline-level"), QString::number(heading));
+	}
+	m_xml.writeAttribute(QStringLiteral("text:style-name"), m_styles.value(block.blockFormatIndex()));
+
+	for (QTextBlock::iterator iter = block.begin(); !iter.atEnd(); ++iter) {
+		const QTextFragment fragment = iter.fragment();
+		const QString style = m_styles.value(fragment.charFormatIndex());
+		if (!style.isEmpty()) {
+			m_xml.writeStartElement(QStringLiteral("text:span"));
+			m_xml.writeAttribute(QStringLiteral("text:style-name"), style);
+		}
+
+		const QString text = fragment.text();
+		int start = 0;
+		int spaces = -1;
+		for (int i = 0, count = text.length(); i < count; ++i) {
+			const QChar c = text.at(i);
+			if (c.unicode() == 0x0) {
+				m_xml.writeCharacters(text.mid(start, i - start));
+				spaces = -1;
+				start = i + 1;
+			} else if (c.unicode() == 0x0009) {
+				m_xml.writeCharacters(text.mid(start, i - start));
+				m_xml.writeEmptyElement(QStringLiteral("text:tab"));
+				spaces = -1;
+				start = i + 1;
+			} else if (c.unicode() == 0x2028) {
+				m_xml.writeCharacters(text.mid(start, i - start));
+				m_xml.writeEmptyElement(QStringLiteral("text:line-break"));
+				spaces = -1;
+				start = i + 1;
+			} else if (c.unicode() == 0x0020) {
+				++spaces;
+			} else if (spaces > 0) {
+				m_xml.writeCharacters(text.mid(start, i - spaces - start));
 				m_xml.writeEmptyElement(QStringLiteral("text:s"));
 				m_xml.writeAttribute(QStringLiteral("text:c"), QString::number(spaces));
+				spaces = -1;
+				start = i;
 			} else {
-				m_xml.writeCharacters(text.mid(start));
-			}
-
-			if (!style.isEmpty()) {
-				m_xml.writeEndElement();
+				spaces = -1;
 			}
 		}
+		if (spaces > 0) {
+			m_xml.writeCharacters(text.mid(start, text.length() - spaces - start));
+			m_xml.writeEmptyElement(QStringLiteral("text:s"));
+			m_xml.writeAttribute(QStringLiteral("text:c"), QString::number(spaces));
+		} else {
+			m_xml.writeCharacters(text.mid(start));
+		}
 
-		m_xml.writeEndElement();
-		m_xml.setAutoFormatting(true);
+		if (!style.isEmpty()) {
+			m_xml.writeEndElement();
+		}
 	}
 
 	m_xml.writeEndElement();
-	m_xml.writeEndElement();
 }
 
 //-----------------------------------------------------------------------------
@@ -11,6 +11,8 @@
 #include <QHash>
 #include <QString>
 #include <QXmlStreamWriter>
+class BlockXmlCache;
+class QTextBlock;
 class QTextBlockFormat;
 class QTextCharFormat;
 class QTextDocument;
@@ -27,6 +29,7 @@ public:
 		return m_error;
 	}
 
+	void setBlockCache(BlockXmlCache* cache);
 	void setFlatXML(bool flat);
 
 	bool write(QIODevice* device, const QTextDocument* document);
@@ -34,17 +37,19 @@ public:
 private:
 	bool writeCompressed(QIODevice* device, const QTextDocument* document);
 	bool writeUncompressed(QIODevice* device, const QTextDocument* document);
-	QByteArray writeDocument(const QTextDocument* document);
-	QByteArray writeStylesDocument(const QTextDocument* document);
+	void writeDocument(QIODevice* device, const QTextDocument* document);
+	void writeStylesDocument(QIODevice* device, const QTextDocument* document);
 	void writeStyles(const QTextDocument* document);
 	void writeAutomaticStyles(const QTextDocument* document);
 	bool writeParagraphStyle(const QTextBlockFormat& format, const QString& name);
 	bool writeTextStyle(const QTextCharFormat& format, const QString& name);
 	void writeBody(const QTextDocument* document);
+	void writeParagraph(const QTextBlock& block);
 
 private:
 	QXmlStreamWriter m_xml;
 	QHash<int, QString> m_styles;
+	BlockXmlCache* m_block_cache;
 	QString m_error;
 	bool m_flat;
 };
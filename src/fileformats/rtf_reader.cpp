@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2010-2022 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2010-2026 Graeme Gott <graeme@gottcode.org>
 	SPDX-FileCopyrightText: 2001 Ewald Snel <ewald@rambo.its.tudelft.nl>
 	SPDX-FileCopyrightText: 2001 Tomasz Grobelny <grotk@poczta.onet.pl>
 	SPDX-FileCopyrightText: 2003, 2004 Nicolas GOUTTE <goutte@kde.org>
@@ -16,13 +16,87 @@
 #include <QFile>
 #include <QTextBlock>
 
+#include <array>
 #include <cmath>
+#include <iterator>
 
 //-----------------------------------------------------------------------------
 
 namespace
 {
 
+// Control words understood by the reader
+constexpr QByteArrayView control_words[] = {
+	"\n", "\r", "'", "*", "-", "\\", "_", "ansi", "ansicpg", "b", "bullet", "colortbl", "cpg", "deff",
+	"emdash", "emspace", "endash", "enspace", "f", "fcharset", "filetbl", "fonttbl", "i", "info",
+	"ldblquote", "li", "line", "lquote", "ltrmark", "ltrpar", "mac", "nosupersub", "outlinelevel",
+	"par", "pard", "pc", "pca", "pict", "plain", "qc", "qj", "ql", "qmspace", "qr", "rdblquote",
+	"rquote", "rtlmark", "rtlpar", "s", "sbasedon", "strike", "striked", "stylesheet", "sub", "super",
+	"tab", "u", "uc", "ul", "uld", "uldash", "uldashd", "uldb", "ulhwave", "ulnone", "ulth",
+	"ululdbwave", "ulw", "ulwave", "zwj", "zwnj", "{", "|", "}", "~"
+};
+constexpr int control_word_count = std::size(control_words);
+
+// Perfect hash of control words, with the seed found at compile time
+constexpr int control_word_slots = 1024;
+
+constexpr int hashControlWord(QByteArrayView word, quint32 seed)
+{
+	quint32 hash = 2166136261u ^ seed;
+	for (qsizetype i = 0; i < word.size(); ++i) {
+		hash ^= static_cast<uchar>(word[i]);
+		hash *= 16777619u;
+	}
+	return (hash ^ (hash >> 15)) & (control_word_slots - 1);
+}
+
+struct ControlWordHash
+{
+	quint32 seed;
+	std::array<quint8, control_word_slots> slots; // index of control word plus one, or zero if empty
+};
+
+constexpr ControlWordHash createControlWordHash()
+{
+	for (quint32 seed = 0; seed < 0x10000; ++seed) {
+		ControlWordHash result{ seed, {} };
+		bool perfect = true;
+		for (int i = 0; perfect && (i < control_word_count); ++i) {
+			quint8& slot = result.slots[hashControlWord(control_words[i], seed)];
+			perfect = !slot;
+			slot = i + 1;
+		}
+		if (perfect) {
+			return result;
+		}
+	}
+	return ControlWordHash{ 0, {} };
+}
+
+constexpr ControlWordHash control_word_hash = createControlWordHash();
+
+constexpr bool isPerfectHash()
+{
+	for (int i = 0; i < control_word_count; ++i) {
+		if (control_word_hash.slots[hashControlWord(control_words[i], control_word_hash.seed)] != (i + 1)) {
+			return false;
+		}
+	}
+	return true;
+}
+static_assert(isPerfectHash(), "Unable to find perfect hash for RTF control words");
+
+int findControlWord(QByteArrayView word)
+{
+	const int index = control_word_hash.slots[hashControlWord(word, control_word_hash.seed)] - 1;
+	return ((index != -1) && (control_words[index] == word)) ? index : -1;
+}
+
+QByteArray rawData(QByteArrayView data)
+{
+	return QByteArray::fromRawData(data.data(), data.size());
+}
+
 TextCodec* codecForCodePage(qint32 value)
 {
 	TextCodec* codec = nullptr;
@@ -83,14 +157,14 @@ public:
 	{
 	}
 
-	void call(RtfReader* reader, const RtfTokenizer& token) const
+	void call(RtfReader* reader, int word, const RtfTokenizer& token) const
 	{
-		m_functions[token.text()].call(reader, token);
+		m_functions[word].call(reader, token);
 	}
 
-	bool contains(const QByteArray& name) const
+	bool contains(int word) const
 	{
-		return m_functions.contains(name);
+		return (word != -1) && m_functions[word].isValid();
 	}
 
 	void groupEnd(RtfReader* reader) const
@@ -107,12 +181,19 @@ public:
 
 	bool isEmpty() const
 	{
-		return m_functions.isEmpty();
+		for (const Function& function : m_functions) {
+			if (function.isValid()) {
+				return false;
+			}
+		}
+		return true;
 	}
 
-	void set(const QByteArray& name, void (RtfReader::*func)(qint32), qint32 value = 0)
+	void set(QByteArrayView name, void (RtfReader::*func)(qint32), qint32 value = 0)
 	{
-		m_functions[name] = Function(func, value);
+		const int word = findControlWord(name);
+		Q_ASSERT(word != -1);
+		m_functions[word] = Function(func, value);
 	}
 
 	void setGroupEnd(void (RtfReader::*groupEndFunc)())
@@ -125,9 +206,11 @@ public:
 		m_insert_text_func = insertTextFunc;
 	}
 
-	void unset(const QByteArray& name)
+	void unset(QByteArrayView name)
 	{
-		m_functions.remove(name);
+		const int word = findControlWord(name);
+		Q_ASSERT(word != -1);
+		m_functions[word] = Function();
 	}
 
 private:
@@ -148,11 +231,16 @@ private:
 			(reader->*m_func)(token.hasValue() ? token.value() : m_value);
 		}
 
+		bool isValid() const
+		{
+			return m_func;
+		}
+
 	private:
 		void (RtfReader::*m_func)(qint32);
 		qint32 m_value;
 	};
-	QHash<QByteArray, Function> m_functions;
+	std::array<Function, control_word_count> m_functions;
 }
 functions,
 stylesheet_functions,
@@ -337,17 +425,18 @@ void RtfReader::readData(QIODevice* device)
 			throw tr("Not a supported RTF file.");
 		}
 		m_token.readNext();
-		if (m_token.type() != ControlWordToken || m_token.text() != "rtf" || m_token.value() != 1) {
+		if (m_token.type() != ControlWordToken || m_token.text() != QByteArrayView("rtf") || m_token.value() != 1) {
 			throw tr("Not a supported RTF file.");
 		}
 
 		// Parse file contents
-		while (!m_states.isEmpty() && m_token.hasNext()) {
+		while (!m_states.isEmpty() && m_token.hasNext() && !isCancelled()) {
 			m_token.readNext();
 
 			if ((m_token.type() != EndGroupToken) && !m_in_block) {
 				m_cursor.insertBlock(m_state.block_format);
 				m_in_block = true;
+				setProgress(m_token.position(), m_token.size());
 			}
 
 			if (m_token.type() == StartGroupToken) {
@@ -356,12 +445,15 @@ void RtfReader::readData(QIODevice* device)
 				m_state.functions->groupEnd(this);
 				popState();
 			} else if (m_token.type() == ControlWordToken) {
-				if (!m_state.ignore_control_word && m_state.functions->contains(m_token.text())) {
-					m_state.functions->call(this, m_token);
+				if (!m_state.ignore_control_word) {
+					const int word = findControlWord(m_token.text());
+					if (m_state.functions->contains(word)) {
+						m_state.functions->call(this, word, m_token);
+					}
 				}
 			} else if (m_token.type() == TextToken) {
 				if (!m_state.ignore_text) {
-					m_state.functions->insertText(this, m_codec->toUnicode(m_token.text()));
+					m_state.functions->insertText(this, m_codec->toUnicode(rawData(m_token.text())));
 				}
 			}
 		}
@@ -397,7 +489,7 @@ void RtfReader::ignoreText(qint32)
 
 void RtfReader::insertHexSymbol(qint32)
 {
-	m_cursor.insertText(m_codec->toUnicode(m_token.hex()));
+	m_cursor.insertText(m_codec->toUnicode(rawData(m_token.hex())));
 }
 
 //-----------------------------------------------------------------------------
@@ -430,7 +522,7 @@ void RtfReader::insertUnicodeSymbol(qint32 value)
 		if (m_token.type() == TextToken) {
 			const int len = m_token.text().length();
 			if (len > i) {
-				m_cursor.insertText(m_codec->toUnicode(m_token.text().mid(i)));
+				m_cursor.insertText(m_codec->toUnicode(rawData(m_token.text().sliced(i))));
 				break;
 			} else {
 				i -= len;
@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2010-2013 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2010-2026 Graeme Gott <graeme@gottcode.org>
 	SPDX-FileCopyrightText: 2001 Ewald Snel <ewald@rambo.its.tudelft.nl>
 	SPDX-FileCopyrightText: 2001 Tomasz Grobelny <grotk@poczta.onet.pl>
 	SPDX-FileCopyrightText: 2005 Tommi Rantala <tommi.rantala@cs.helsinki.fi>
@@ -14,23 +14,82 @@
 #include <QCoreApplication>
 #include <QIODevice>
 
+#include <array>
+#include <limits>
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+enum CharacterClass : quint8
+{
+	LetterCharacter = 0x1,
+	DigitCharacter = 0x2,
+	HexCharacter = 0x4,
+	DelimiterCharacter = 0x8
+};
+
+constexpr std::array<quint8, 256> createCharacterClasses()
+{
+	std::array<quint8, 256> classes{};
+	for (int c = 'a'; c <= 'z'; ++c) {
+		classes[c] |= LetterCharacter;
+		classes[c - 'a' + 'A'] |= LetterCharacter;
+	}
+	for (int c = '0'; c <= '9'; ++c) {
+		classes[c] |= DigitCharacter | HexCharacter;
+	}
+	for (int c = 'a'; c <= 'f'; ++c) {
+		classes[c] |= HexCharacter;
+		classes[c - 'a' + 'A'] |= HexCharacter;
+	}
+	classes['\\'] |= DelimiterCharacter;
+	classes['{'] |= DelimiterCharacter;
+	classes['}'] |= DelimiterCharacter;
+	classes['\n'] |= DelimiterCharacter;
+	classes['\r'] |= DelimiterCharacter;
+	return classes;
+}
+
+constexpr std::array<quint8, 256> character_classes = createCharacterClasses();
+
+inline bool isClass(char c, quint8 type)
+{
+	return character_classes[static_cast<uchar>(c)] & type;
+}
+
+int hexValue(char c)
+{
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	} else if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	} else {
+		return c - 'A' + 10;
+	}
+}
+
+}
+
 //-----------------------------------------------------------------------------
 
 RtfTokenizer::RtfTokenizer()
 	: m_device(nullptr)
-	, m_position(0)
+	, m_position(-1)
+	, m_type(TextToken)
+	, m_hex(0)
+	, m_has_hex(false)
 	, m_value(0)
 	, m_has_value(false)
 {
-	m_buffer.reserve(8192);
-	m_text.reserve(8192);
 }
 
 //-----------------------------------------------------------------------------
 
 bool RtfTokenizer::hasNext() const
 {
-	return (m_position < m_buffer.length() - 1) || !m_device->atEnd();
+	return m_position < m_buffer.size() - 1;
 }
 
 //-----------------------------------------------------------------------------
@@ -39,8 +98,9 @@ void RtfTokenizer::readNext()
 {
 	// Reset values
 	m_type = TextToken;
-	m_hex.clear();
-	m_text.resize(0);
+	m_hex = 0;
+	m_has_hex = false;
+	m_text = QByteArrayView();
 	m_value = 0;
 	m_has_value = false;
 	if (!m_device) {
@@ -62,26 +122,32 @@ void RtfTokenizer::readNext()
 		m_type = ControlWordToken;
 
 		c = next();
+		const qsizetype start = m_position;
 
-		if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+		if (isClass(c, LetterCharacter)) {
 			// Read control word
-			while ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
-				m_text.append(c);
+			do {
 				c = next();
-			}
+			} while (isClass(c, LetterCharacter));
+			m_text = QByteArrayView(m_buffer.constData() + start, m_position - start);
 
 			// Read integer value
 			const int sign = (c != '-') ? 1 : -1;
 			if (sign == -1) {
 				c = next();
 			}
-			QByteArray value;
-			while (isdigit(c)) {
-				value.append(c);
+			qint64 value = 0;
+			int digits = 0;
+			while (isClass(c, DigitCharacter)) {
+				value = (value * 10) + (c - '0');
+				if (value > std::numeric_limits<qint32>::max()) {
+					value = std::numeric_limits<qint32>::max() + qint64(1);
+				}
+				++digits;
 				c = next();
 			}
-			m_has_value = !value.isEmpty();
-			m_value = value.toInt() * sign;
+			m_has_value = digits > 0;
+			m_value = (value <= std::numeric_limits<qint32>::max()) ? (value * sign) : 0;
 
 			// Eat space after control word
 			if (c != ' ') {
@@ -89,32 +155,36 @@ void RtfTokenizer::readNext()
 			}
 
 			// Eat binary value
-			if (m_text == "bin") {
+			if (m_text == QByteArrayView("bin")) {
 				if (m_value > 0) {
-					for (int i = 0; i < m_value; i++) {
-						next();
+					if (m_value > (m_buffer.size() - m_position - 1)) {
+						throw tr("Unexpectedly reached end of file.");
 					}
+					m_position += m_value;
 				}
 				return readNext();
 			}
 		} else if (c == '\'') {
 			// Read hexadecimal value
-			m_text.append(c);
-			QByteArray hex(2, 0);
-			hex[0] = next();
-			hex[1] = next();
-			m_hex.append(hex.toInt(0, 16));
+			m_text = QByteArrayView(m_buffer.constData() + start, 1);
+			const char high = next();
+			const char low = next();
+			if (isClass(high, HexCharacter) && isClass(low, HexCharacter)) {
+				m_hex = char((hexValue(high) << 4) | hexValue(low));
+			}
+			m_has_hex = true;
 		} else {
 			// Read escaped character
-			m_text.append(c);
+			m_text = QByteArrayView(m_buffer.constData() + start, 1);
 		}
 	} else {
 		// Read text
 		m_type = TextToken;
-		while (c != '\\' && c != '{' && c != '}' && c != '\n' && c != '\r') {
-			m_text.append(c);
+		const qsizetype start = m_position;
+		while (!isClass(c, DelimiterCharacter)) {
 			c = next();
 		}
+		m_text = QByteArrayView(m_buffer.constData() + start, m_position - start);
 		m_position--;
 	}
 }
@@ -123,7 +193,10 @@ void RtfTokenizer::readNext()
 
 void RtfTokenizer::setDevice(QIODevice* device)
 {
+	// Read entire contents so that tokens can reference it without copying
 	m_device = device;
+	m_buffer = m_device ? m_device->readAll() : QByteArray();
+	m_position = -1;
 }
 
 //-----------------------------------------------------------------------------
@@ -131,14 +204,8 @@ void RtfTokenizer::setDevice(QIODevice* device)
 char RtfTokenizer::next()
 {
 	m_position++;
-	if (m_position >= m_buffer.length()) {
-		m_buffer.resize(8192);
-		const int size = m_device->read(m_buffer.data(), m_buffer.length());
-		if (size < 1) {
-			throw tr("Unexpectedly reached end of file.");
-		}
-		m_buffer.resize(size);
-		m_position = 0;
+	if (m_position >= m_buffer.size()) {
+		throw tr("Unexpectedly reached end of file.");
 	}
 	return m_buffer.at(m_position);
 }
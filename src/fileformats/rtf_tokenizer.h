@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2010-2013 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2010-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -8,6 +8,7 @@
 #define FOCUSWRITER_RTF_TOKENIZER_H
 
 #include <QByteArray>
+#include <QByteArrayView>
 #include <QCoreApplication>
 class QIODevice;
 
@@ -28,11 +29,14 @@ public:
 
 	bool hasNext() const;
 	bool hasValue() const;
-	QByteArray hex() const;
-	QByteArray text() const;
+	QByteArrayView hex() const;
+	QByteArrayView text() const;
 	RtfTokenType type() const;
 	qint32 value() const;
 
+	qint64 position() const;
+	qint64 size() const;
+
 	void readNext();
 	void setDevice(QIODevice* device);
 
@@ -42,11 +46,12 @@ private:
 private:
 	QIODevice* m_device;
 	QByteArray m_buffer;
-	int m_position;
+	qsizetype m_position;
 
 	RtfTokenType m_type;
-	QByteArray m_hex;
-	QByteArray m_text;
+	char m_hex;
+	bool m_has_hex;
+	QByteArrayView m_text;
 	qint32 m_value;
 	bool m_has_value;
 };
@@ -56,12 +61,12 @@ inline bool RtfTokenizer::hasValue() const
 	return m_has_value;
 }
 
-inline QByteArray RtfTokenizer::hex() const
+inline QByteArrayView RtfTokenizer::hex() const
 {
-	return m_hex;
+	return m_has_hex ? QByteArrayView(&m_hex, 1) : QByteArrayView();
 }
 
-inline QByteArray RtfTokenizer::text() const
+inline QByteArrayView RtfTokenizer::text() const
 {
 	return m_text;
 }
@@ -76,4 +81,14 @@ inline qint32 RtfTokenizer::value() const
 	return m_value;
 }
 
+inline qint64 RtfTokenizer::position() const
+{
+	return m_position;
+}
+
+inline qint64 RtfTokenizer::size() const
+{
+	return m_buffer.size();
+}
+
 #endif // FOCUSWRITER_RTF_TOKENIZER_H
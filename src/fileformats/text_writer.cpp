@@ -0,0 +1,102 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "text_writer.h"
+
+#include <QIODevice>
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+// Size of buffer before it is written to device
+const qsizetype buffer_size = 0x10000;
+
+// Amount of text encoded at a time, small enough to always fit in buffer
+const qsizetype encode_size = 0x2000;
+
+}
+
+//-----------------------------------------------------------------------------
+
+TextWriter::TextWriter(QIODevice* device, bool write_bom)
+	: m_device(device)
+	, m_encoder(QStringConverter::Utf8)
+	, m_error(false)
+{
+	m_buffer.reserve(buffer_size);
+
+	// Write byte order mark before anything else, since raw data skips encoder
+	if (write_bom) {
+		m_buffer.append("\xEF\xBB\xBF");
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+TextWriter::~TextWriter()
+{
+	flush();
+}
+
+//-----------------------------------------------------------------------------
+
+bool TextWriter::flush()
+{
+	if (!m_buffer.isEmpty()) {
+		if (m_device->write(m_buffer) != m_buffer.size()) {
+			m_error = true;
+		}
+		m_buffer.resize(0);
+	}
+	return !m_error;
+}
+
+//-----------------------------------------------------------------------------
+
+void TextWriter::write(QStringView text)
+{
+	while (!text.isEmpty()) {
+		const QStringView part = text.first(qMin(text.size(), encode_size));
+		text = text.sliced(part.size());
+
+		// Leave room for surrogate pair split between parts
+		const qsizetype length = m_encoder.requiredSpace(part.size()) + 4;
+		reserve(length);
+		const qsizetype start = m_buffer.size();
+		m_buffer.resize(start + length);
+		char* end = m_encoder.appendToBuffer(m_buffer.data() + start, part);
+		m_buffer.resize(end - m_buffer.constData());
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void TextWriter::write(QByteArrayView data)
+{
+	if (data.size() > buffer_size) {
+		flush();
+		if (m_device->write(data.data(), data.size()) != data.size()) {
+			m_error = true;
+		}
+		return;
+	}
+
+	reserve(data.size());
+	m_buffer.append(data);
+}
+
+//-----------------------------------------------------------------------------
+
+void TextWriter::reserve(qsizetype length)
+{
+	if ((m_buffer.size() + length) > buffer_size) {
+		flush();
+	}
+}
+
+//-----------------------------------------------------------------------------
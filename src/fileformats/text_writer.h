@@ -0,0 +1,47 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef FOCUSWRITER_TEXT_WRITER_H
+#define FOCUSWRITER_TEXT_WRITER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QStringEncoder>
+#include <QStringView>
+class QIODevice;
+
+// Encodes text into a bounded buffer that is written to a device whenever it fills up
+class TextWriter
+{
+public:
+	explicit TextWriter(QIODevice* device, bool write_bom = false);
+	~TextWriter();
+
+	TextWriter(const TextWriter&) = delete;
+	TextWriter& operator=(const TextWriter&) = delete;
+
+	bool flush();
+	bool hasError() const;
+
+	void write(QStringView text);
+	void write(QByteArrayView data);
+
+private:
+	void reserve(qsizetype length);
+
+private:
+	QIODevice* m_device;
+	QStringEncoder m_encoder;
+	QByteArray m_buffer;
+	bool m_error;
+};
+
+inline bool TextWriter::hasError() const
+{
+	return m_error;
+}
+
+#endif // FOCUSWRITER_TEXT_WRITER_H
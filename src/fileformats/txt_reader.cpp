@@ -1,27 +1,129 @@
 /*
-	SPDX-FileCopyrightText: 2013-2020 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2013-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
 
 #include "txt_reader.h"
 
-#include <QTextStream>
+#include <QFileDevice>
+#include <QStringDecoder>
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+// Amount of file decoded and inserted at a time
+const qint64 chunk_size = 0x100000;
+
+}
 
 //-----------------------------------------------------------------------------
 
 TxtReader::TxtReader()
+	: m_device(nullptr)
+	, m_file(nullptr)
+	, m_mapped(nullptr)
+	, m_offset(0)
+	, m_total(0)
+	, m_head_length(0)
+	, m_at_end(false)
 {
 }
 
 //-----------------------------------------------------------------------------
 
+TxtReader::~TxtReader()
+{
+	if (m_mapped) {
+		m_file->unmap(m_mapped);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+QString TxtReader::readBatch(qint64 size)
+{
+	QString batch;
+	while (batch.isEmpty() && !m_at_end && !isCancelled()) {
+		QByteArrayView data;
+		if (m_mapped) {
+			if (m_offset < m_total) {
+				data = QByteArrayView(m_mapped + m_offset, qMin(size, m_total - m_offset));
+			}
+		} else {
+			m_buffer = m_device->read(size);
+			data = m_buffer;
+		}
+
+		// Return partial paragraph at end of file
+		if (data.isEmpty()) {
+			m_at_end = true;
+			batch = m_text;
+			m_text.clear();
+			if (m_mapped) {
+				m_file->unmap(m_mapped);
+				m_mapped = nullptr;
+			}
+			break;
+		}
+		m_offset += data.size();
+
+		// Detect encoding from first chunk, in the same way as QTextStream
+		if (!m_decoder.isValid()) {
+			m_decoder = QStringDecoder(QStringConverter::encodingForData(data).value_or(QStringConverter::Utf8));
+		}
+		m_text += m_decoder.decode(data);
+
+		// Keep partial paragraph for next batch, unless it is already too long
+		qsizetype length = m_text.lastIndexOf(QLatin1Char('\n')) + 1;
+		if (!length && (m_text.length() > size)) {
+			length = m_text.endsWith(QLatin1Char('\r')) ? (m_text.length() - 1) : m_text.length();
+		}
+		if (length) {
+			batch = m_text.left(length);
+			m_text.remove(0, length);
+		}
+
+		setProgress(m_offset, m_total);
+	}
+	return batch;
+}
+
+//-----------------------------------------------------------------------------
+
+void TxtReader::setHeadLength(qsizetype length)
+{
+	m_head_length = length;
+}
+
+//-----------------------------------------------------------------------------
+
 void TxtReader::readData(QIODevice* device)
 {
 	m_cursor.beginEditBlock();
 
-	QTextStream stream(device);
-	m_cursor.insertText(stream.readAll());
+	// Map file into memory instead of copying it when possible
+	const qint64 start = device->pos();
+	m_device = device;
+	m_total = device->size() - start;
+	m_file = qobject_cast<QFileDevice*>(device);
+	if (m_file && !m_file->isSequential() && (m_total > 0)) {
+		m_mapped = m_file->map(start, m_total);
+	}
+
+	// Insert text in batches of whole paragraphs; stop after head if rest is read later by readBatch()
+	const qint64 size = m_head_length ? qMin(chunk_size, qint64(m_head_length)) : chunk_size;
+	qsizetype inserted = 0;
+	while (!m_head_length || (inserted < m_head_length)) {
+		const QString batch = readBatch(size);
+		if (batch.isEmpty()) {
+			break;
+		}
+		m_cursor.insertText(batch);
+		inserted += batch.length();
+	}
 
 	m_cursor.endEditBlock();
 }
@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2013 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2013-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -9,10 +9,15 @@
 
 #include "format_reader.h"
 
+#include <QByteArray>
+#include <QStringDecoder>
+class QFileDevice;
+
 class TxtReader : public FormatReader
 {
 public:
 	explicit TxtReader();
+	~TxtReader();
 
 	enum { Type = 1 };
 	int type() const override
@@ -26,8 +31,28 @@ public:
 		return true;
 	}
 
+	bool atEnd() const
+	{
+		return m_at_end;
+	}
+
+	QString readBatch(qint64 size);
+	void setHeadLength(qsizetype length);
+
 private:
 	void readData(QIODevice* device) override;
+
+private:
+	QIODevice* m_device;
+	QFileDevice* m_file;
+	uchar* m_mapped;
+	qint64 m_offset;
+	qint64 m_total;
+	QStringDecoder m_decoder;
+	QByteArray m_buffer;
+	QString m_text;
+	qsizetype m_head_length;
+	bool m_at_end;
 };
 
 #endif // FOCUSWRITER_TXT_READER_H
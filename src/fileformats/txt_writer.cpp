@@ -0,0 +1,47 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "txt_writer.h"
+
+#include "text_writer.h"
+
+#include <QTextBlock>
+#include <QTextDocument>
+
+//-----------------------------------------------------------------------------
+
+TxtWriter::TxtWriter()
+	: m_write_bom(false)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+bool TxtWriter::write(QIODevice* device, const QTextDocument* document)
+{
+	TextWriter writer(device, m_write_bom);
+
+	// Write a block at a time, converting characters like QTextDocument::toPlainText()
+	for (QTextBlock block = document->begin(); block.isValid(); block = block.next()) {
+		if (block != document->begin()) {
+			writer.write("\n");
+		}
+
+		QString text = block.text();
+		for (QChar& c : text) {
+			if (c == QChar::Nbsp) {
+				c = QLatin1Char(' ');
+			} else if (c == QChar::LineSeparator) {
+				c = QLatin1Char('\n');
+			}
+		}
+		writer.write(text);
+	}
+
+	return writer.flush();
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,31 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef FOCUSWRITER_TXT_WRITER_H
+#define FOCUSWRITER_TXT_WRITER_H
+
+class QIODevice;
+class QTextDocument;
+
+class TxtWriter
+{
+public:
+	explicit TxtWriter();
+
+	void setWriteByteOrderMark(bool write_bom);
+
+	bool write(QIODevice* device, const QTextDocument* document);
+
+private:
+	bool m_write_bom;
+};
+
+inline void TxtWriter::setWriteByteOrderMark(bool write_bom)
+{
+	m_write_bom = write_bom;
+}
+
+#endif // FOCUSWRITER_TXT_WRITER_H
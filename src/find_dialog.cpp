@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2008-2025 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2008-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -7,23 +7,67 @@
 #include "find_dialog.h"
 
 #include "document.h"
+#include "find_engine.h"
+#include "format_manager.h"
+#include "format_reader.h"
+#include "session.h"
 #include "smart_quotes.h"
 #include "stack.h"
+#include "word_index.h"
 
+#include <QtConcurrentMap>
 #include <QApplication>
 #include <QCheckBox>
 #include <QDialogButtonBox>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
 #include <QGridLayout>
 #include <QKeyEvent>
 #include <QLabel>
 #include <QLineEdit>
+#include <QListWidget>
 #include <QMessageBox>
+#include <QTextDocument>
 #include <QTextEdit>
 #include <QPushButton>
 #include <QRadioButton>
 #include <QRegularExpression>
 #include <QScreen>
+#include <QSet>
 #include <QSettings>
+#include <QTimer>
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+// Text of a document to search, or the file to read it from if it is not loaded
+struct FindAllItem
+{
+	QString filename;
+	QList<FindEngine::Block> blocks;
+};
+
+QString matchContext(const FindEngine::Block& block, const FindEngine::Match& match)
+{
+	const int context = 40;
+	const int start = match.position - block.position;
+	const int before = qMax(0, start - context);
+	const int after = qMin(int(block.text.length()), start + match.length + context);
+
+	QString result = block.text.mid(before, after - before).simplified();
+	if (before > 0) {
+		result.prepend(QChar(0x2026));
+	}
+	if (after < block.text.length()) {
+		result.append(QChar(0x2026));
+	}
+	return result;
+}
+
+}
 
 //-----------------------------------------------------------------------------
 
@@ -43,6 +87,16 @@ FindDialog::FindDialog(Stack* documents)
 	m_regular_expressions = new QCheckBox(tr("Regular expressions"), this);
 	connect(m_regular_expressions, &QCheckBox::toggled, m_whole_words, &QCheckBox::setDisabled);
 
+	// Mark matches after typing pauses
+	m_highlight_timer = new QTimer(this);
+	m_highlight_timer->setInterval(150);
+	m_highlight_timer->setSingleShot(true);
+	connect(m_highlight_timer, &QTimer::timeout, this, &FindDialog::highlightMatches);
+	connect(m_ignore_case, &QCheckBox::toggled, m_highlight_timer, qOverload<>(&QTimer::start));
+	connect(m_whole_words, &QCheckBox::toggled, m_highlight_timer, qOverload<>(&QTimer::start));
+	connect(m_regular_expressions, &QCheckBox::toggled, m_highlight_timer, qOverload<>(&QTimer::start));
+	connect(m_documents, &Stack::currentDocumentChanged, this, &FindDialog::highlightMatches);
+
 	m_search_backwards = new QRadioButton(tr("Search up"), this);
 	QRadioButton* search_forwards = new QRadioButton(tr("Search down"), this);
 	search_forwards->setChecked(true);
@@ -56,6 +110,11 @@ FindDialog::FindDialog(Stack* documents)
 	m_find_button->setDefault(true);
 	connect(m_find_button, &QPushButton::clicked, this, qOverload<>(&FindDialog::find));
 
+	m_find_all_button = buttons->addButton(tr("Find in All &Documents"), QDialogButtonBox::ActionRole);
+	m_find_all_button->setEnabled(false);
+	m_find_all_button->setAutoDefault(false);
+	connect(m_find_all_button, &QPushButton::clicked, this, &FindDialog::findAll);
+
 	m_replace_button = buttons->addButton(tr("&Replace"), QDialogButtonBox::ActionRole);
 	m_replace_button->setEnabled(false);
 	m_replace_button->setAutoDefault(false);
@@ -66,6 +125,16 @@ FindDialog::FindDialog(Stack* documents)
 	m_replace_all_button->setAutoDefault(false);
 	connect(m_replace_all_button, &QPushButton::clicked, this, &FindDialog::replaceAll);
 
+	// Create list of matches in all documents
+	m_results = new QListWidget(this);
+	m_results->setUniformItemSizes(true);
+	m_results->hide();
+	connect(m_results, &QListWidget::itemActivated, this, &FindDialog::showResult);
+
+	m_results_watcher = new QFutureWatcher<QList<Result>>(this);
+	connect(m_results_watcher, &QFutureWatcherBase::resultReadyAt, this, &FindDialog::findAllResultReady);
+	connect(m_results_watcher, &QFutureWatcherBase::finished, this, &FindDialog::findAllFinished);
+
 	if (!buttons->button(QDialogButtonBox::Close)->icon().isNull()) {
 		m_find_button->setIcon(QIcon::fromTheme("edit-find"));
 		m_replace_button->setIcon(QIcon::fromTheme("edit-find-replace"));
@@ -84,6 +153,7 @@ FindDialog::FindDialog(Stack* documents)
 	layout->addWidget(m_search_backwards, 2, 2);
 	layout->addWidget(search_forwards, 3, 2);
 	layout->addWidget(buttons, 5, 0, 1, 3);
+	layout->addWidget(m_results, 6, 0, 1, 3);
 	setFixedWidth(sizeHint().width());
 
 	// Load settings
@@ -99,6 +169,13 @@ FindDialog::FindDialog(Stack* documents)
 
 //-----------------------------------------------------------------------------
 
+FindDialog::~FindDialog()
+{
+	stopFindAll();
+}
+
+//-----------------------------------------------------------------------------
+
 bool FindDialog::eventFilter(QObject* watched, QEvent* event)
 {
 	if ((event->type() == QEvent::KeyPress) && qobject_cast<QLineEdit*>(watched)) {
@@ -132,6 +209,9 @@ void FindDialog::reject()
 	settings.setValue("FindDialog/WholeWords", m_whole_words->isChecked());
 	settings.setValue("FindDialog/RegularExpressions", m_regular_expressions->isChecked());
 	settings.setValue("FindDialog/SearchBackwards", m_search_backwards->isChecked());
+	stopFindAll();
+	m_highlight_timer->stop();
+	clearHighlights();
 	QDialog::reject();
 }
 
@@ -181,13 +261,161 @@ void FindDialog::find()
 
 //-----------------------------------------------------------------------------
 
+void FindDialog::findAll()
+{
+	const FindEngine engine(m_find_string->text(), m_ignore_case->isChecked(), m_whole_words->isChecked(), m_regular_expressions->isChecked());
+	if (engine.isEmpty()) {
+		return;
+	}
+
+	stopFindAll();
+	m_results->clear();
+	m_results_documents.clear();
+	m_results_files.clear();
+	m_results_counts.clear();
+
+	// Copy text of loaded documents; dormant documents are read from their files instead
+	QList<FindAllItem> items;
+	QSet<QString> opened;
+	for (int i = 0, count = m_documents->count(); i < count; ++i) {
+		Document* document = m_documents->document(i);
+		FindAllItem item;
+		if (document->isDormant()) {
+			item.filename = document->filename();
+		} else {
+			item.blocks = FindEngine::blocks(document->text()->document());
+		}
+		items.append(item);
+		m_results_documents.append(document);
+		m_results_files.append(document->filename());
+		m_results_counts.append(0);
+		opened.insert(QFileInfo(document->filename()).canonicalFilePath());
+	}
+
+	// Also read files of session that have been closed since it was last saved
+	const Session session(QSettings().value("SessionManager/Session").toString());
+	const QStringList files = session.files();
+	for (const QString& file : files) {
+		const QString canonical_filename = QFileInfo(file).canonicalFilePath();
+		if (canonical_filename.isEmpty() || opened.contains(canonical_filename)) {
+			continue;
+		}
+		opened.insert(canonical_filename);
+
+		items.append({ file, QList<FindEngine::Block>() });
+		m_results_documents.append(nullptr);
+		m_results_files.append(file);
+		m_results_counts.append(0);
+	}
+
+	m_results->show();
+	setFixedHeight(sizeHint().height());
+
+	// Search documents in parallel; matches are listed as each document finishes
+	m_results_watcher->setFuture(QtConcurrent::mapped(std::move(items), [engine](const FindAllItem& item) {
+		QList<FindEngine::Block> blocks = item.blocks;
+		if (!item.filename.isEmpty()) {
+			QFile file(item.filename);
+			if (file.open(QIODevice::ReadOnly)) {
+				QTextDocument document;
+				document.setUndoRedoEnabled(false);
+				FormatReader* reader = FormatManager::createReader(&file, item.filename.section(QLatin1Char('.'), -1).toLower());
+				reader->read(&file, &document);
+				delete reader;
+				blocks = FindEngine::blocks(&document);
+			}
+		}
+
+		// Pair each match with its block for context; both are sorted by position
+		QList<Result> results;
+		const QList<FindEngine::Match> matches = engine.find(blocks);
+		qsizetype block = 0;
+		for (const FindEngine::Match& match : matches) {
+			while (((block + 1) < blocks.count()) && (blocks.at(block + 1).position <= match.position)) {
+				++block;
+			}
+			results.append({ match.position, match.length, matchContext(blocks.at(block), match) });
+		}
+		return results;
+	}));
+}
+
+//-----------------------------------------------------------------------------
+
+void FindDialog::findAllFinished()
+{
+	if (!m_results_watcher->isCanceled() && !m_results->count()) {
+		QMessageBox::information(this, tr("Sorry"), tr("Phrase not found."));
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void FindDialog::findAllResultReady(int index)
+{
+	const Document* document = m_results_documents.at(index);
+	const QList<Result> results = m_results_watcher->resultAt(index);
+	if (results.isEmpty() || (!document && m_results_files.at(index).isEmpty())) {
+		return;
+	}
+
+	// Keep matches in the same order as the documents
+	int row = 0;
+	for (int i = 0; i < index; ++i) {
+		row += m_results_counts.at(i);
+	}
+	m_results_counts[index] = results.count();
+
+	const QString title = document ? document->title() : QFileInfo(m_results_files.at(index)).fileName();
+	for (const Result& result : results) {
+		QListWidgetItem* item = new QListWidgetItem(QString("%1: %2").arg(title, result.context));
+		item->setData(Qt::UserRole, index);
+		item->setData(Qt::UserRole + 1, result.position);
+		item->setData(Qt::UserRole + 2, result.length);
+		m_results->insertItem(row, item);
+		++row;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
 void FindDialog::findChanged(const QString& text)
 {
 	const bool enabled = !text.isEmpty();
 	m_find_button->setEnabled(enabled);
+	m_find_all_button->setEnabled(enabled);
 	m_replace_button->setEnabled(enabled);
 	m_replace_all_button->setEnabled(enabled);
 	Q_EMIT findNextAvailable(enabled);
+	m_highlight_timer->start();
+}
+
+//-----------------------------------------------------------------------------
+
+void FindDialog::highlightMatches()
+{
+	clearHighlights();
+
+	// Regular expressions are only matched when asked, since they can be slow
+	const FindEngine engine(m_find_string->text(), m_ignore_case->isChecked(), m_whole_words->isChecked(), m_regular_expressions->isChecked());
+	Document* document = m_documents->currentDocument();
+	if (engine.isEmpty() || m_regular_expressions->isChecked() || !document || !isVisible()) {
+		return;
+	}
+
+	// Limit how many matches are marked so that typing stays responsive
+	QTextDocument* text = document->text()->document();
+	const QList<FindEngine::Match> matches = engine.find(text, document->wordIndex(), 500);
+	QList<QTextCursor> highlights;
+	highlights.reserve(matches.count());
+	for (const FindEngine::Match& match : matches) {
+		QTextCursor cursor(text);
+		cursor.setPosition(match.position);
+		cursor.setPosition(match.position + match.length, QTextCursor::KeepAnchor);
+		highlights.append(cursor);
+	}
+	document->setHighlights(highlights);
+	m_highlighted = document;
 }
 
 //-----------------------------------------------------------------------------
@@ -223,44 +451,16 @@ void FindDialog::replace()
 
 void FindDialog::replaceAll()
 {
-	const QString text = m_find_string->text();
-	if (text.isEmpty()) {
+	FindEngine engine(m_find_string->text(), m_ignore_case->isChecked(), m_whole_words->isChecked(), m_regular_expressions->isChecked());
+	if (engine.isEmpty()) {
 		return;
 	}
-	const QRegularExpression regex(text, m_ignore_case->isChecked() ? QRegularExpression::CaseInsensitiveOption : QRegularExpression::NoPatternOption);
-
-	QTextDocument::FindFlags flags;
-	if (!m_ignore_case->isChecked()) {
-		flags |= QTextDocument::FindCaseSensitively;
-	}
-	if (m_whole_words->isChecked() && !m_regular_expressions->isChecked()) {
-		flags |= QTextDocument::FindWholeWords;
-	}
+	engine.setReplacement(m_replace_string->text());
 
-	// Count instances
-	int found = 0;
+	// Find instances
 	QTextEdit* document = m_documents->currentDocument()->text();
-	QTextCursor cursor = document->textCursor();
-	cursor.movePosition(QTextCursor::Start);
-	if (!m_regular_expressions->isChecked()) {
-		Q_FOREVER {
-			cursor = document->document()->find(text, cursor, flags);
-			if (!cursor.isNull()) {
-				found++;
-			} else {
-				break;
-			}
-		}
-	} else {
-		Q_FOREVER {
-			cursor = document->document()->find(regex, cursor, flags);
-			if (!cursor.isNull() && cursor.hasSelection()) {
-				found++;
-			} else {
-				break;
-			}
-		}
-	}
+	const QList<FindEngine::Match> matches = engine.find(document->document(), m_documents->currentDocument()->wordIndex());
+	const int found = matches.count();
 	if (found) {
 		if (QMessageBox::question(this,
 				tr("Question"),
@@ -273,31 +473,9 @@ void FindDialog::replaceAll()
 		return;
 	}
 
-	// Replace instances
-	QTextCursor start_cursor = document->textCursor();
-	start_cursor.beginEditBlock();
-	if (!m_regular_expressions->isChecked()) {
-		Q_FOREVER {
-			cursor = document->document()->find(text, cursor, flags);
-			if (!cursor.isNull()) {
-				cursor.insertText(m_replace_string->text());
-			} else {
-				break;
-			}
-		}
-	} else {
-		Q_FOREVER {
-			cursor = document->document()->find(regex, cursor, flags);
-			if (!cursor.isNull() && cursor.hasSelection()) {
-				QString match = cursor.selectedText();
-				match.replace(regex, m_replace_string->text());
-				cursor.insertText(match);
-			} else {
-				break;
-			}
-		}
-	}
-	start_cursor.endEditBlock();
+	// Replace instances in a single edit so that the document only updates once
+	const QTextCursor start_cursor = document->textCursor();
+	FindEngine::replace(start_cursor, matches);
 	document->setTextCursor(start_cursor);
 }
 
@@ -348,6 +526,56 @@ void FindDialog::find(bool backwards)
 
 //-----------------------------------------------------------------------------
 
+void FindDialog::showResult(QListWidgetItem* item)
+{
+	const int index = item->data(Qt::UserRole).toInt();
+	Document* document = m_results_documents.value(index);
+	if (document) {
+		// Switch to document, which loads it again if it is dormant
+		m_documents->showDocument(document);
+	} else {
+		// Open file that is not open, or that was closed after it was searched
+		const QString filename = m_results_files.value(index);
+		if (filename.isEmpty()) {
+			return;
+		}
+		m_documents->openDocument(filename);
+
+		const QString canonical_filename = QFileInfo(filename).canonicalFilePath();
+		document = m_documents->currentDocument();
+		if (QFileInfo(document->filename()).canonicalFilePath() != canonical_filename) {
+			return;
+		}
+		m_results_documents[index] = document;
+	}
+	if (document != m_documents->currentDocument()) {
+		return;
+	}
+
+	// Select match unless document has changed so much that it no longer fits
+	const int position = item->data(Qt::UserRole + 1).toInt();
+	const int length = item->data(Qt::UserRole + 2).toInt();
+	QTextEdit* text = document->text();
+	if ((position + length) < text->document()->characterCount()) {
+		QTextCursor cursor = text->textCursor();
+		cursor.setPosition(position);
+		cursor.setPosition(position + length, QTextCursor::KeepAnchor);
+		text->setTextCursor(cursor);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void FindDialog::clearHighlights()
+{
+	if (m_highlighted) {
+		m_highlighted->setHighlights(QList<QTextCursor>());
+		m_highlighted = nullptr;
+	}
+}
+
+//-----------------------------------------------------------------------------
+
 void FindDialog::showMode(bool replace)
 {
 	m_replace_label->setVisible(replace);
@@ -367,6 +595,15 @@ void FindDialog::showMode(bool replace)
 
 	show();
 	activateWindow();
+	highlightMatches();
+}
+
+//-----------------------------------------------------------------------------
+
+void FindDialog::stopFindAll()
+{
+	m_results_watcher->cancel();
+	m_results_watcher->waitForFinished();
 }
 
 //-----------------------------------------------------------------------------
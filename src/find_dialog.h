@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2008-2012 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2008-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -7,13 +7,21 @@
 #ifndef FOCUSWRITER_FIND_DIALOG_H
 #define FOCUSWRITER_FIND_DIALOG_H
 
+class Document;
 class Stack;
 
 #include <QDialog>
+#include <QList>
+#include <QPointer>
+#include <QStringList>
 class QCheckBox;
 class QLabel;
 class QLineEdit;
+class QListWidget;
+class QListWidgetItem;
 class QRadioButton;
+class QTimer;
+template<typename T> class QFutureWatcher;
 
 class FindDialog : public QDialog
 {
@@ -21,6 +29,7 @@ class FindDialog : public QDialog
 
 public:
 	explicit FindDialog(Stack* documents);
+	~FindDialog();
 
 	bool eventFilter(QObject* watched, QEvent* event) override;
 
@@ -40,16 +49,37 @@ protected:
 
 private Q_SLOTS:
 	void find();
+	void findAll();
+	void findAllFinished();
+	void findAllResultReady(int index);
 	void findChanged(const QString& text);
+	void highlightMatches();
+	void showResult(QListWidgetItem* item);
 	void replace();
 	void replaceAll();
 
 private:
 	void find(bool backwards);
+	void clearHighlights();
 	void showMode(bool replace);
+	void stopFindAll();
 
 private:
 	Stack* m_documents;
+	QPointer<Document> m_highlighted;
+	QTimer* m_highlight_timer;
+
+	struct Result
+	{
+		int position;
+		int length;
+		QString context;
+	};
+	QFutureWatcher<QList<Result>>* m_results_watcher;
+	QList<QPointer<Document>> m_results_documents;
+	QStringList m_results_files;
+	QList<int> m_results_counts;
+	QListWidget* m_results;
 
 	QLineEdit* m_find_string;
 	QLabel* m_replace_label;
@@ -61,6 +91,7 @@ private:
 	QRadioButton* m_search_backwards;
 
 	QPushButton* m_find_button;
+	QPushButton* m_find_all_button;
 	QPushButton* m_replace_button;
 	QPushButton* m_replace_all_button;
 
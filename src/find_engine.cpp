@@ -0,0 +1,194 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "find_engine.h"
+
+#include "block_stats.h"
+#include "word_index.h"
+
+#include <QtConcurrentRun>
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+
+//-----------------------------------------------------------------------------
+
+FindEngine::FindEngine(const QString& text, bool ignore_case, bool whole_words, bool regular_expressions)
+	: m_text(text)
+	, m_case_sensitivity(ignore_case ? Qt::CaseInsensitive : Qt::CaseSensitive)
+	, m_whole_words(whole_words && !regular_expressions)
+	, m_regular_expressions(regular_expressions)
+	, m_replace(false)
+{
+	if (m_regular_expressions) {
+		m_regex = QRegularExpression(text, ignore_case ? QRegularExpression::CaseInsensitiveOption : QRegularExpression::NoPatternOption);
+		m_regex.optimize();
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void FindEngine::setReplacement(const QString& replacement)
+{
+	m_replace = true;
+	m_replacement = replacement;
+}
+
+//-----------------------------------------------------------------------------
+
+QList<FindEngine::Match> FindEngine::find(const QTextDocument* document, const WordIndex* index, int limit) const
+{
+	if (!m_regular_expressions) {
+		return findText(document, index, limit);
+	}
+	const QList<Block> text = blocks(document);
+
+	// Keep window responsive while regular expression is matched in other thread
+	const FindEngine engine = *this;
+	QFutureWatcher<QList<Match>> watcher;
+	QEventLoop loop;
+	QObject::connect(&watcher, &QFutureWatcherBase::finished, &loop, &QEventLoop::quit);
+	watcher.setFuture(QtConcurrent::run([engine, text] {
+		return engine.find(text);
+	}));
+	if (!watcher.isFinished()) {
+		loop.exec(QEventLoop::ExcludeUserInputEvents);
+	}
+	QList<Match> matches = watcher.result();
+	if ((limit != -1) && (matches.count() > limit)) {
+		matches.resize(limit);
+	}
+	return matches;
+}
+
+//-----------------------------------------------------------------------------
+
+QList<FindEngine::Match> FindEngine::find(const QList<Block>& blocks) const
+{
+	QList<Match> matches;
+	if (m_text.isEmpty() || (m_regular_expressions && !m_regex.isValid())) {
+		return matches;
+	}
+
+	for (const Block& block : blocks) {
+		// Search text the same way as QTextDocument::find()
+		QString text = block.text;
+		text.replace(QChar::Nbsp, QLatin1Char(' '));
+		if (m_regular_expressions) {
+			findRegularExpression(block, text, matches);
+		} else {
+			findText(block.position, text, matches);
+		}
+	}
+	return matches;
+}
+
+//-----------------------------------------------------------------------------
+
+QList<FindEngine::Block> FindEngine::blocks(const QTextDocument* document)
+{
+	QList<Block> result;
+	result.reserve(document->blockCount());
+	for (QTextBlock i = document->begin(); i.isValid(); i = i.next()) {
+		result.append({ i.position(), i.text() });
+	}
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+void FindEngine::replace(QTextCursor cursor, const QList<Match>& matches)
+{
+	// Replace from the end so that positions of earlier matches stay valid
+	cursor.beginEditBlock();
+	for (auto i = matches.crbegin(), end = matches.crend(); i != end; ++i) {
+		cursor.setPosition(i->position);
+		cursor.setPosition(i->position + i->length, QTextCursor::KeepAnchor);
+		cursor.insertText(i->replacement);
+	}
+	cursor.endEditBlock();
+}
+
+//-----------------------------------------------------------------------------
+
+void FindEngine::findRegularExpression(const Block& block, const QString& text, QList<Match>& matches) const
+{
+	QRegularExpressionMatchIterator i = m_regex.globalMatch(text);
+	while (i.hasNext()) {
+		const QRegularExpressionMatch match = i.next();
+		if (!match.capturedLength()) {
+			continue;
+		}
+
+		Match result{ block.position + int(match.capturedStart()), int(match.capturedLength()), QString() };
+		if (m_replace) {
+			// Build replacement from original text so that non-breaking spaces are kept
+			result.replacement = block.text.mid(match.capturedStart(), match.capturedLength());
+			result.replacement.replace(m_regex, m_replacement);
+		}
+		matches.append(result);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+QList<FindEngine::Match> FindEngine::findText(const QTextDocument* document, const WordIndex* index, int limit) const
+{
+	QList<Match> matches;
+	if (m_text.isEmpty()) {
+		return matches;
+	}
+
+	// Only search blocks that contain every word of a whole word search
+	const QStringList words = (index && m_whole_words) ? WordIndex::words(m_text) : QStringList();
+	const bool filter = !words.isEmpty();
+	const QSet<const BlockStats*> candidates = filter ? index->blocks(words) : QSet<const BlockStats*>();
+
+	// Search text of each block in place instead of copying the whole document first
+	for (QTextBlock i = document->begin(); i.isValid(); i = i.next()) {
+		// Blocks without stats are not in the index yet, so they are always searched
+		if (filter) {
+			const BlockStats* stats = static_cast<BlockStats*>(i.userData());
+			if (stats && !candidates.contains(stats)) {
+				continue;
+			}
+		}
+
+		// Search text the same way as QTextDocument::find()
+		QString text = i.text();
+		text.replace(QChar::Nbsp, QLatin1Char(' '));
+		findText(i.position(), text, matches);
+		if ((limit != -1) && (matches.count() >= limit)) {
+			matches.resize(limit);
+			break;
+		}
+	}
+	return matches;
+}
+
+//-----------------------------------------------------------------------------
+
+void FindEngine::findText(int position, const QString& text, QList<Match>& matches) const
+{
+	const qsizetype length = m_text.length();
+	qsizetype index = 0;
+	while ((index = text.indexOf(m_text, index, m_case_sensitivity)) != -1) {
+		if (m_whole_words) {
+			const qsizetype end = index + length;
+			if (((index > 0) && text.at(index - 1).isLetterOrNumber()) || ((end < text.length()) && text.at(end).isLetterOrNumber())) {
+				++index;
+				continue;
+			}
+		}
+
+		matches.append({ position + int(index), int(length), m_replacement });
+		index += length;
+	}
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,65 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef FOCUSWRITER_FIND_ENGINE_H
+#define FOCUSWRITER_FIND_ENGINE_H
+
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+class QTextCursor;
+class QTextDocument;
+class WordIndex;
+
+// Finds every match of a search in a document with a single pass over the text of its blocks
+class FindEngine
+{
+public:
+	struct Block
+	{
+		int position;
+		QString text;
+	};
+
+	struct Match
+	{
+		int position;
+		int length;
+		QString replacement;
+	};
+
+	explicit FindEngine(const QString& text, bool ignore_case, bool whole_words, bool regular_expressions);
+
+	bool isEmpty() const;
+	void setReplacement(const QString& replacement);
+
+	QList<Match> find(const QTextDocument* document, const WordIndex* index = nullptr, int limit = -1) const;
+	QList<Match> find(const QList<Block>& blocks) const;
+
+	static QList<Block> blocks(const QTextDocument* document);
+	static void replace(QTextCursor cursor, const QList<Match>& matches);
+
+private:
+	void findRegularExpression(const Block& block, const QString& text, QList<Match>& matches) const;
+	QList<Match> findText(const QTextDocument* document, const WordIndex* index, int limit) const;
+	void findText(int position, const QString& text, QList<Match>& matches) const;
+
+private:
+	QString m_text;
+	QRegularExpression m_regex;
+	Qt::CaseSensitivity m_case_sensitivity;
+	bool m_whole_words;
+	bool m_regular_expressions;
+	bool m_replace;
+	QString m_replacement;
+};
+
+inline bool FindEngine::isEmpty() const
+{
+	return m_text.isEmpty();
+}
+
+#endif // FOCUSWRITER_FIND_ENGINE_H
@@ -8,7 +8,11 @@
 
 #include <QApplication>
 #include <QGraphicsOpacityEffect>
+#include <QKeyEvent>
+#include <QMouseEvent>
 #include <QPainter>
+#include <QProgressBar>
+#include <QPushButton>
 #include <QTimer>
 #include <QVBoxLayout>
 
@@ -45,10 +49,27 @@ LoadScreen::LoadScreen(QWidget* parent)
 	m_text->setAlignment(Qt::AlignCenter);
 	m_text->setStyleSheet("QLabel {color: #d7d7d7; background-color: #1e1e1e; border-top-left-radius: 0.25em; border-top-right-radius: 0.25em; padding: 0.25em 0.5em;}");
 
+	m_progress = new QProgressBar(this);
+	m_progress->hide();
+	m_progress->setCursor(Qt::WaitCursor);
+	m_progress->setRange(0, 100);
+	m_progress->setTextVisible(false);
+	m_progress->setFixedHeight(4);
+	m_progress->setStyleSheet("QProgressBar {background-color: #1e1e1e; border: none;} QProgressBar::chunk {background-color: #d7d7d7;}");
+
+	m_cancel = new QPushButton(tr("Cancel"), this);
+	m_cancel->hide();
+	m_cancel->setCursor(Qt::ArrowCursor);
+	connect(m_cancel, &QPushButton::clicked, this, &LoadScreen::cancelled);
+
 	QVBoxLayout* layout = new QVBoxLayout(this);
 	layout->setContentsMargins(0, 0, 0, 0);
+	layout->setSpacing(0);
 	layout->addStretch();
+	layout->addWidget(m_cancel, 0, Qt::AlignCenter);
+	layout->addSpacing(12);
 	layout->addWidget(m_text, 0, Qt::AlignCenter);
+	layout->addWidget(m_progress);
 
 	m_hide_effect = new QGraphicsOpacityEffect(this);
 	m_hide_effect->setOpacity(1.0);
@@ -64,6 +85,29 @@ LoadScreen::LoadScreen(QWidget* parent)
 
 bool LoadScreen::eventFilter(QObject* watched, QEvent* event)
 {
+	// Allow cancelling current step
+	if (m_cancel->isVisible()) {
+		switch (event->type()) {
+		case QEvent::KeyPress:
+			if (static_cast<QKeyEvent*>(event)->key() == Qt::Key_Escape) {
+				m_cancel->click();
+				return true;
+			}
+			break;
+
+		case QEvent::MouseButtonDblClick:
+		case QEvent::MouseButtonPress:
+		case QEvent::MouseButtonRelease:
+			if (m_cancel->rect().contains(m_cancel->mapFromGlobal(static_cast<QMouseEvent*>(event)->globalPosition().toPoint()))) {
+				return QLabel::eventFilter(watched, event);
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
 	switch (event->type()) {
 	case QEvent::KeyPress:
 	case QEvent::KeyRelease:
@@ -91,6 +135,8 @@ void LoadScreen::setText(const QString& step)
 {
 	m_text->setText("<pre>" + step + "</pre>");
 	m_text->setVisible(!step.isEmpty());
+	m_progress->hide();
+	m_cancel->hide();
 
 	if (m_hide_timer->isActive()) {
 		m_hide_timer->stop();
@@ -105,8 +151,26 @@ void LoadScreen::setText(const QString& step)
 
 //-----------------------------------------------------------------------------
 
+void LoadScreen::setProgress(int progress)
+{
+	// Only steps that can be cancelled report progress
+	if (progress < 0) {
+		m_progress->hide();
+		m_cancel->hide();
+		return;
+	}
+
+	m_progress->setValue(progress);
+	m_progress->show();
+	m_cancel->show();
+}
+
+//-----------------------------------------------------------------------------
+
 void LoadScreen::finish()
 {
+	m_progress->hide();
+	m_cancel->hide();
 	m_hide_effect->setOpacity(1.0);
 	m_hide_effect->setEnabled(true);
 	m_hide_timer->start();
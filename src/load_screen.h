@@ -10,6 +10,8 @@
 #include <QLabel>
 #include <QPixmap>
 class QGraphicsOpacityEffect;
+class QProgressBar;
+class QPushButton;
 class QTimer;
 
 class LoadScreen : public QLabel
@@ -21,8 +23,12 @@ public:
 
 	bool eventFilter(QObject* watched, QEvent* event) override;
 
+Q_SIGNALS:
+	void cancelled();
+
 public Q_SLOTS:
 	void setText(const QString& step);
+	void setProgress(int progress);
 	void finish();
 
 protected:
@@ -37,6 +43,8 @@ private:
 	QPixmap m_pixmap;
 	QSizeF m_pixmap_center;
 	QLabel* m_text;
+	QProgressBar* m_progress;
+	QPushButton* m_cancel;
 	QGraphicsOpacityEffect* m_hide_effect;
 	QTimer* m_hide_timer;
 };
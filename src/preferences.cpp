@@ -27,6 +27,7 @@ Preferences::Preferences()
 	, m_page_paragraphs(1, 100)
 	, m_page_words(1, 2000)
 	, m_wordcount_type(0, 2)
+	, m_background_memory(0, 16384)
 	, m_save_format(FormatManager::types())
 {
 	forgetChanges();
@@ -95,6 +96,7 @@ void Preferences::reload()
 	m_double_quotes = settings.value("Edit/SmartDoubleQuotes", -1).toInt();
 	m_single_quotes = settings.value("Edit/SmartSingleQuotes", -1).toInt();
 	m_typewriter_sounds = settings.value("Edit/TypewriterSounds", false).toBool();
+	m_background_memory = settings.value("Edit/BackgroundMemory", 256).toInt();
 
 	m_scene_divider = settings.value("SceneList/Divider", QLatin1String("##")).toString();
 	SceneModel::setSceneDivider(m_scene_divider);
@@ -153,6 +155,7 @@ void Preferences::write()
 	settings.setValue("Edit/SmartDoubleQuotes", m_double_quotes);
 	settings.setValue("Edit/SmartSingleQuotes", m_single_quotes);
 	settings.setValue("Edit/TypewriterSounds", m_typewriter_sounds);
+	settings.setValue("Edit/BackgroundMemory", m_background_memory.value());
 
 	settings.setValue("SceneList/Divider", m_scene_divider);
 
@@ -65,6 +65,7 @@ public:
 	int doubleQuotes() const { return m_double_quotes; }
 	int singleQuotes() const { return m_single_quotes; }
 	bool typewriterSounds() const { return m_typewriter_sounds; }
+	RangedInt backgroundMemory() const { return m_background_memory; }
 	void setAlwaysCenter(bool center) { setValue(m_always_center, center); }
 	void setBlockCursor(bool block) { setValue(m_block_cursor, block); }
 	void setSmoothFonts(bool smooth) { setValue(m_smooth_fonts, smooth); }
@@ -72,6 +73,7 @@ public:
 	void setDoubleQuotes(int quotes) { setValue(m_double_quotes, quotes); }
 	void setSingleQuotes(int quotes) { setValue(m_single_quotes, quotes); }
 	void setTypewriterSounds(bool sounds){ setValue(m_typewriter_sounds, sounds); }
+	void setBackgroundMemory(int megabytes) { setValue(m_background_memory, megabytes); }
 
 	QString sceneDivider() const{ return m_scene_divider; }
 	void setSceneDivider(const QString& divider);
@@ -137,6 +139,7 @@ private:
 	int m_double_quotes;
 	int m_single_quotes;
 	bool m_typewriter_sounds;
+	RangedInt m_background_memory;
 
 	QString m_scene_divider;
 
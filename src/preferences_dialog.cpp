@@ -146,6 +146,7 @@ PreferencesDialog::PreferencesDialog(DailyProgress* daily_progress, QWidget* par
 #ifndef __OS2__
 	m_typewriter_sounds->setChecked(Preferences::instance().typewriterSounds());
 #endif
+	m_background_memory->setValue(Preferences::instance().backgroundMemory());
 
 	m_scene_divider->setText(Preferences::instance().sceneDivider());
 
@@ -270,6 +271,7 @@ void PreferencesDialog::accept()
 	Preferences::instance().setDoubleQuotes(m_double_quotes->currentIndex());
 	Preferences::instance().setSingleQuotes(m_single_quotes->currentIndex());
 	Preferences::instance().setTypewriterSounds(m_typewriter_sounds->isChecked());
+	Preferences::instance().setBackgroundMemory(m_background_memory->value());
 
 	Preferences::instance().setSceneDivider(m_scene_divider->text());
 
@@ -695,12 +697,27 @@ QWidget* PreferencesDialog::initGeneralTab()
 	quotes_layout->addWidget(m_single_quotes);
 	quotes_layout->addStretch();
 
+	QLabel* background_memory_label = new QLabel(tr("Memory for background documents:"), edit_group);
+	m_background_memory = new QSpinBox(edit_group);
+	m_background_memory->setCorrectionMode(QSpinBox::CorrectToNearestValue);
+	m_background_memory->setRange(Preferences::instance().backgroundMemory().minimumValue(), Preferences::instance().backgroundMemory().maximumValue());
+	m_background_memory->setSingleStep(64);
+	m_background_memory->setSuffix(tr(" MB"));
+	background_memory_label->setBuddy(m_background_memory);
+
+	QHBoxLayout* background_memory_layout = new QHBoxLayout;
+	background_memory_layout->setContentsMargins(0, 0, 0, 0);
+	background_memory_layout->addWidget(background_memory_label);
+	background_memory_layout->addWidget(m_background_memory);
+	background_memory_layout->addStretch();
+
 	QVBoxLayout* edit_layout = new QVBoxLayout(edit_group);
 	edit_layout->addWidget(m_always_center);
 	edit_layout->addWidget(m_block_cursor);
 	edit_layout->addWidget(m_smooth_fonts);
 	edit_layout->addLayout(quotes_layout);
 	edit_layout->addWidget(m_typewriter_sounds);
+	edit_layout->addLayout(background_memory_layout);
 
 	// Create section options
 	QGroupBox* scene_group = new QGroupBox(tr("Scenes"), tab);
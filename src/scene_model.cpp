@@ -28,7 +28,7 @@ SceneModel::SceneModel(QTextEdit* document, QObject* parent)
 	, m_document(document)
 	, m_updates(0)
 {
-	connect(m_document->document(), &QTextDocument::blockCountChanged, this, &SceneModel::invalidateScenes);
+	connectDocument();
 
 	f_scene_models.append(this);
 }
@@ -42,6 +42,13 @@ SceneModel::~SceneModel()
 
 //-----------------------------------------------------------------------------
 
+void SceneModel::connectDocument()
+{
+	connect(m_document->document(), &QTextDocument::blockCountChanged, this, &SceneModel::invalidateScenes);
+}
+
+//-----------------------------------------------------------------------------
+
 QModelIndex SceneModel::findScene(const QTextCursor& cursor) const
 {
 	// Find block stats for text cursor
@@ -32,6 +32,7 @@ public:
 	explicit SceneModel(QTextEdit* document, QObject* parent = nullptr);
 	~SceneModel();
 
+	void connectDocument();
 	QModelIndex findScene(const QTextCursor& cursor) const;
 	void moveScenes(QList<int> scenes, int row);
 	void removeScene(const BlockStats* stats);
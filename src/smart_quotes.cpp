@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2010-2014 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2010-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -12,7 +12,9 @@
 #include <QLineEdit>
 #include <QLocale>
 #include <QProgressDialog>
+#include <QTextBlock>
 #include <QTextCursor>
+#include <QTextDocument>
 #include <QTextEdit>
 
 //-----------------------------------------------------------------------------
@@ -132,44 +134,81 @@ bool SmartQuotes::insert(QTextEdit* text, QKeyEvent* key)
 
 void SmartQuotes::replace(QTextEdit* text, int start, int end)
 {
+	struct Edit
+	{
+		int position;
+		int length;
+		QString text;
+		QTextCharFormat format;
+	};
+
+	// Find quotes to replace in one pass over the text of each block
+	QList<Edit> edits;
+	const QTextDocument* document = text->document();
+	QChar previous = document->characterAt(start - 1);
+	QString replaced;
+	for (QTextBlock block = document->findBlock(start); block.isValid() && (block.position() < end); block = block.next()) {
+		if (block.position() > start) {
+			previous = QChar::ParagraphSeparator;
+		}
+
+		// Edit each run of text with the same formatting so that formatting is kept
+		const QString block_text = block.text();
+		for (QTextBlock::iterator i = block.begin(); !i.atEnd(); ++i) {
+			const QTextFragment fragment = i.fragment();
+			const int first = qMax(fragment.position(), start);
+			const int last = qMin(fragment.position() + fragment.length(), end);
+			if (first >= last) {
+				continue;
+			}
+
+			const QStringView original = QStringView(block_text).sliced(first - block.position(), last - first);
+			if (!replace(original, previous, replaced)) {
+				continue;
+			}
+
+			// Only replace the text between the first and last changed quotes
+			const qsizetype shortest = qMin(original.length(), replaced.length());
+			qsizetype prefix = 0;
+			while ((prefix < shortest) && (original.at(prefix) == replaced.at(prefix))) {
+				++prefix;
+			}
+			qsizetype suffix = 0;
+			while (((prefix + suffix) < shortest) && (original.at(original.length() - suffix - 1) == replaced.at(replaced.length() - suffix - 1))) {
+				++suffix;
+			}
+			edits.append({ first + int(prefix),
+					int(original.length() - prefix - suffix),
+					replaced.mid(prefix, replaced.length() - prefix - suffix),
+					fragment.charFormat() });
+		}
+	}
+	if (edits.isEmpty()) {
+		return;
+	}
+
 	QProgressDialog progress(text);
 	progress.setCancelButton(nullptr);
 	progress.setLabelText(tr("Replacing quotation marks..."));
 	progress.setWindowTitle(tr("Please Wait"));
 	progress.setModal(true);
-	progress.setMinimum(start);
-	progress.setMaximum(end);
-	progress.setMinimumDuration(0);
+	progress.setMinimum(0);
+	progress.setMaximum(edits.count());
+	progress.setMinimumDuration(500);
 
+	// Apply edits from the end so that positions of earlier edits stay valid
 	QTextCursor cursor(text->document());
 	cursor.beginEditBlock();
-	QChar previous = text->document()->characterAt(start - 1);
-	int length = 0;
-	for (int i = start; i < end; ++i) {
-		const QChar c = text->document()->characterAt(i);
-		int quote = 2;
-		if (c == '"') {
-			quote = 0;
-		} else if (c != '\'') {
-			previous = c;
-			continue;
+	for (qsizetype i = edits.count() - 1; i >= 0; --i) {
+		const Edit& edit = edits.at(i);
+		cursor.setPosition(edit.position);
+		cursor.setPosition(edit.position + edit.length, QTextCursor::KeepAnchor);
+		cursor.insertText(edit.text, edit.format);
+
+		const qsizetype done = edits.count() - i;
+		if ((done % 1000) == 0) {
+			progress.setValue(done);
 		}
-
-		if (!previous.isSpace() && !previous.isNull() && (previous.category() != QChar::Punctuation_Open)) {
-			quote++;
-		}
-		previous = c;
-
-		if (QString(c) != m_quotes[quote]) {
-			cursor.setPosition(i);
-			cursor.deleteChar();
-			cursor.insertText(m_quotes[quote]);
-			length = m_quotes[quote].length() - 1;
-			i += length;
-			end += length;
-		}
-
-		progress.setValue(i);
 	}
 	cursor.endEditBlock();
 }
@@ -179,29 +218,9 @@ void SmartQuotes::replace(QTextEdit* text, int start, int end)
 void SmartQuotes::replace(QString& string)
 {
 	QChar previous;
-	int end = string.length();
-	int length = 0;
-	for (int i = 0; i < end; ++i) {
-		const QChar c = string.at(i);
-		int quote = 2;
-		if (c == '"') {
-			quote = 0;
-		} else if (c != '\'') {
-			previous = c;
-			continue;
-		}
-
-		if (!previous.isSpace() && !previous.isNull() && (previous.category() != QChar::Punctuation_Open)) {
-			quote++;
-		}
-		previous = c;
-
-		if (QString(c) != m_quotes[quote]) {
-			string.replace(i, 1, m_quotes[quote]);
-			length = m_quotes[quote].length() - 1;
-			i += length;
-			end += length;
-		}
+	QString replaced;
+	if (replace(string, previous, replaced)) {
+		string = replaced;
 	}
 }
 
@@ -339,6 +358,45 @@ void SmartQuotes::loadPreferences()
 
 //-----------------------------------------------------------------------------
 
+bool SmartQuotes::replace(QStringView text, QChar& previous, QString& result)
+{
+	bool changed = false;
+	result.clear();
+	for (qsizetype i = 0, length = text.length(); i < length; ++i) {
+		const QChar c = text.at(i);
+		int quote = 2;
+		if (c == '"') {
+			quote = 0;
+		} else if (c != '\'') {
+			previous = c;
+			if (changed) {
+				result.append(c);
+			}
+			continue;
+		}
+
+		if (!previous.isSpace() && !previous.isNull() && (previous.category() != QChar::Punctuation_Open)) {
+			quote++;
+		}
+		previous = c;
+
+		if (QStringView(&c, 1) != m_quotes[quote]) {
+			// Copy text lazily, since most runs of text have no quotes to replace
+			if (!changed) {
+				result.reserve(length + 16);
+				result.append(text.first(i));
+				changed = true;
+			}
+			result.append(m_quotes[quote]);
+		} else if (changed) {
+			result.append(c);
+		}
+	}
+	return changed;
+}
+
+//-----------------------------------------------------------------------------
+
 void SmartQuotes::setQuotes(size_t index_double, size_t index_single)
 {
 	const Quotes& double_quotes = m_quotes_list[index_double];
@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2010-2014 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2010-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -9,6 +9,7 @@
 
 #include <QChar>
 #include <QCoreApplication>
+#include <QStringView>
 class QKeyEvent;
 class QLineEdit;
 class QTextEdit;
@@ -32,6 +33,7 @@ public:
 	static void loadPreferences();
 
 private:
+	static bool replace(QStringView text, QChar& previous, QString& result);
 	static void setQuotes(size_t index_double, size_t index_single);
 
 private:
@@ -7,10 +7,13 @@
 #ifndef FOCUSWRITER_ABSTRACT_DICTIONARY_H
 #define FOCUSWRITER_ABSTRACT_DICTIONARY_H
 
+class SpellingCache;
 class WordRef;
 
 #include <QStringList>
 
+// Dictionaries are shared with the spell checking threads, so check() and
+// suggestions() must be safe to call while the session is being changed.
 class AbstractDictionary
 {
 public:
@@ -18,6 +21,11 @@ public:
 	{
 	}
 
+	virtual const SpellingCache* cache() const
+	{
+		return nullptr;
+	}
+
 	virtual bool isValid() const = 0;
 	virtual WordRef check(const QString& string, int start_at) const = 0;
 	virtual QStringList suggestions(const QString& word) const = 0;
@@ -9,8 +9,10 @@
 #include "dictionary_manager.h"
 #include "locale_dialog.h"
 #include "preferences.h"
+#include "spelling_cache.h"
 
 #include <QDialogButtonBox>
+#include <QLabel>
 #include <QListWidget>
 #include <QListWidgetItem>
 #include <QVBoxLayout>
@@ -40,6 +42,29 @@ DictionaryDialog::DictionaryDialog(QWidget* parent)
 
 	QVBoxLayout* layout = new QVBoxLayout(this);
 	layout->addWidget(m_languages, 1);
+#ifndef QT_NO_DEBUG
+	// Show spelling cache usage of loaded dictionaries
+	QStringList statistics;
+	const QStringList loaded = DictionaryManager::instance().loadedDictionaries();
+	for (const QString& language : loaded) {
+		const SpellingCache* cache = DictionaryManager::instance().cache(language);
+		if (!cache) {
+			continue;
+		}
+		const quint64 lookups = cache->hits() + cache->misses();
+		statistics += QString("%1: %L2 words cached, %L3 of %L4 lookups hit (%L5%)")
+				.arg(language)
+				.arg(cache->count())
+				.arg(cache->hits())
+				.arg(lookups)
+				.arg(lookups ? (100.0 * cache->hits() / lookups) : 0.0, 0, 'f', 1);
+	}
+	if (!statistics.isEmpty()) {
+		QLabel* label = new QLabel(statistics.join("\n"), this);
+		label->setTextInteractionFlags(Qt::TextSelectableByMouse);
+		layout->addWidget(label);
+	}
+#endif
 	layout->addSpacing(layout->contentsMargins().top());
 	layout->addWidget(buttons);
 }
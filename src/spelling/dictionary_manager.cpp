@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2009-2020 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2009-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -117,6 +117,23 @@ QString DictionaryManager::availableDictionary(const QString& language) const
 
 //-----------------------------------------------------------------------------
 
+QStringList DictionaryManager::loadedDictionaries() const
+{
+	QStringList result = m_dictionaries.keys();
+	result.sort();
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+const SpellingCache* DictionaryManager::cache(const QString& language) const
+{
+	const AbstractDictionary* dictionary = m_dictionaries.value(language);
+	return dictionary ? dictionary->cache() : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+
 void DictionaryManager::add(const QString& word)
 {
 	QStringList words = personal();
@@ -166,6 +183,43 @@ void DictionaryManager::addProviders()
 
 //-----------------------------------------------------------------------------
 
+void DictionaryManager::replaceInvalidDictionaries()
+{
+	for (auto i = m_dictionaries.begin(), end = m_dictionaries.end(); i != end; ++i) {
+		if (i.value()->isValid()) {
+			continue;
+		}
+
+		// Keep invalid dictionary, which accepts every word, if no other provider has language
+		AbstractDictionary* dictionary = nullptr;
+		for (AbstractDictionaryProvider* provider : std::as_const(m_providers)) {
+			dictionary = provider->requestDictionary(i.key());
+			if (dictionary && dictionary->isValid()) {
+				break;
+			} else {
+				delete dictionary;
+				dictionary = nullptr;
+			}
+		}
+		if (!dictionary) {
+			continue;
+		}
+		dictionary->addToSession(m_personal);
+
+		// Replaced dictionary can still be in use by spell checks in background
+		if (m_default_dictionary == i.value()) {
+			m_default_dictionary = dictionary;
+		}
+		m_replaced_dictionaries.append(i.value());
+		i.value() = dictionary;
+	}
+
+	// Re-check documents
+	Q_EMIT changed();
+}
+
+//-----------------------------------------------------------------------------
+
 DictionaryRef DictionaryManager::requestDictionary(const QString& language)
 {
 	if (language.isEmpty()) {
@@ -298,6 +352,9 @@ DictionaryManager::~DictionaryManager()
 	}
 	m_dictionaries.clear();
 
+	qDeleteAll(m_replaced_dictionaries);
+	m_replaced_dictionaries.clear();
+
 	qDeleteAll(m_providers);
 	m_providers.clear();
 }
@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2009-2013 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2009-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -10,6 +10,7 @@
 class AbstractDictionary;
 class AbstractDictionaryProvider;
 class DictionaryRef;
+class SpellingCache;
 
 #include <QHash>
 #include <QObject>
@@ -24,11 +25,14 @@ public:
 
 	QStringList availableDictionaries() const;
 	QString availableDictionary(const QString& language) const;
+	QStringList loadedDictionaries() const;
+	const SpellingCache* cache(const QString& language) const;
 	QString defaultLanguage() const;
 	QStringList personal() const;
 
 	void add(const QString& word);
 	void addProviders();
+	void replaceInvalidDictionaries();
 	DictionaryRef requestDictionary(const QString& language = QString());
 	void setDefaultLanguage(const QString& language);
 	void setIgnoreNumbers(bool ignore);
@@ -52,6 +56,7 @@ private:
 private:
 	QList<AbstractDictionaryProvider*> m_providers;
 	QHash<QString, AbstractDictionary*> m_dictionaries;
+	QList<AbstractDictionary*> m_replaced_dictionaries;
 	AbstractDictionary* m_default_dictionary;
 
 	QString m_default_language;
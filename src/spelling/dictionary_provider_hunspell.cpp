@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2009-2022 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2009-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -9,21 +9,30 @@
 #include "abstract_dictionary.h"
 #include "dictionary_manager.h"
 #include "smart_quotes.h"
+#include "spelling_cache.h"
 #include "text_codec.h"
 #include "word_ref.h"
 
+#include <QtConcurrentRun>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QFuture>
+#include <QMutex>
 #include <QRegularExpression>
+#include <QSet>
 #include <QStandardPaths>
 
 #include <hunspell.hxx>
 
+#include <atomic>
+
 //-----------------------------------------------------------------------------
 
 static bool f_ignore_numbers = false;
 static bool f_ignore_uppercase = true;
+static QSet<QString> f_unsupported;
+static QMutex f_unsupported_mutex;
 
 //-----------------------------------------------------------------------------
 
@@ -36,9 +45,14 @@ public:
 	DictionaryHunspell(const QString& language);
 	~DictionaryHunspell();
 
+	const SpellingCache* cache() const override
+	{
+		return &m_cache;
+	}
+
 	bool isValid() const override
 	{
-		return m_dictionary;
+		return m_future.isValid() && !m_failed;
 	}
 
 	WordRef check(const QString& string, int start_at) const override;
@@ -48,9 +62,20 @@ public:
 	void addToSession(const QStringList& words) override;
 	void removeFromSession(const QStringList& words) override;
 
+private:
+	static QByteArray encoding(const QString& aff);
+	void load(const QString& language, const QString& aff, const QString& dic);
+	bool spell(const QString& word) const;
+
 private:
 	Hunspell* m_dictionary;
 	TextCodec* m_codec;
+	std::atomic<bool> m_loaded;
+	std::atomic<bool> m_failed;
+	QStringList m_session;
+	QFuture<void> m_future;
+	mutable QMutex m_mutex;
+	mutable SpellingCache m_cache;
 };
 
 //-----------------------------------------------------------------------------
@@ -58,7 +83,17 @@ private:
 DictionaryHunspell::DictionaryHunspell(const QString& language)
 	: m_dictionary(nullptr)
 	, m_codec(nullptr)
+	, m_loaded(false)
+	, m_failed(false)
 {
+	// Skip languages whose dictionary failed to load before
+	{
+		QMutexLocker locker(&f_unsupported_mutex);
+		if (f_unsupported.contains(language)) {
+			return;
+		}
+	}
+
 	// Find dictionary files
 	QString aff = QFileInfo("dict:" + language + ".aff").absoluteFilePath();
 	if (aff.isEmpty()) {
@@ -74,31 +109,38 @@ DictionaryHunspell::DictionaryHunspell(const QString& language)
 		return;
 	}
 
-	// Create dictionary
-#ifndef Q_WIN32
-	m_dictionary = new Hunspell(QFile::encodeName(aff).constData(), QFile::encodeName(dic).constData());
-#else
-	m_dictionary = new Hunspell( ("\\\\?\\" + QDir::toNativeSeparators(aff)).toUtf8().constData(),
-			("\\\\?\\" + QDir::toNativeSeparators(dic)).toUtf8().constData() );
-#endif
-	m_codec = TextCodec::codecForName(m_dictionary->get_dic_encoding());
-	if (!m_codec) {
-		delete m_dictionary;
-		m_dictionary = nullptr;
+	// Skip dictionary if its encoding is not supported
+	const QByteArray name = encoding(aff);
+	if (!name.isEmpty()) {
+		m_codec = TextCodec::createForName(name);
+		if (!m_codec) {
+			return;
+		}
 	}
+
+	// Parse dictionary in background; words are treated as correct until it is ready
+	m_future = QtConcurrent::run([this, language, aff, dic] {
+		load(language, aff, dic);
+	});
 }
 
 //-----------------------------------------------------------------------------
 
 DictionaryHunspell::~DictionaryHunspell()
 {
+	m_future.waitForFinished();
 	delete m_dictionary;
+	delete m_codec;
 }
 
 //-----------------------------------------------------------------------------
 
 WordRef DictionaryHunspell::check(const QString& string, int start_at) const
 {
+	if (!m_loaded) {
+		return WordRef();
+	}
+
 	int index = -1;
 	int length = 0;
 	int chars = 1;
@@ -155,11 +197,7 @@ WordRef DictionaryHunspell::check(const QString& string, int start_at) const
 			if (!is_uppercase && !is_number) {
 				QString word = string.mid(index, length);
 				word.replace(QChar(0x2019), QLatin1Char('\''));
-#ifdef H_DEPRECATED
-				if (!m_dictionary->spell(m_codec->fromUnicode(word).toStdString())) {
-#else
-				if (!m_dictionary->spell(m_codec->fromUnicode(word).constData())) {
-#endif
+				if (!spell(word)) {
 					return WordRef(index, length);
 				}
 			}
@@ -178,8 +216,13 @@ WordRef DictionaryHunspell::check(const QString& string, int start_at) const
 QStringList DictionaryHunspell::suggestions(const QString& word) const
 {
 	QStringList result;
+	if (!m_loaded) {
+		return result;
+	}
+
 	QString check = word;
 	check.replace(QChar(0x2019), QLatin1Char('\''));
+	QMutexLocker locker(&m_mutex);
 #ifdef H_DEPRECATED
 	const std::vector<std::string> suggestions = m_dictionary->suggest(m_codec->fromUnicode(check).toStdString());
 	for (const std::string& suggestion : suggestions) {
@@ -217,18 +260,116 @@ void DictionaryHunspell::addToPersonal(const QString& word)
 
 void DictionaryHunspell::addToSession(const QStringList& words)
 {
+	QMutexLocker locker(&m_mutex);
+	if (!m_loaded) {
+		m_session += words;
+		return;
+	}
+
 	for (const QString& word : words) {
 		m_dictionary->add(m_codec->fromUnicode(word).constData());
 	}
+	m_cache.remove(words);
 }
 
 //-----------------------------------------------------------------------------
 
 void DictionaryHunspell::removeFromSession(const QStringList& words)
 {
+	QMutexLocker locker(&m_mutex);
+	if (!m_loaded) {
+		for (const QString& word : words) {
+			m_session.removeAll(word);
+		}
+		return;
+	}
+
 	for (const QString& word : words) {
 		m_dictionary->remove(m_codec->fromUnicode(word).constData());
 	}
+	m_cache.remove(words);
+}
+
+//-----------------------------------------------------------------------------
+
+QByteArray DictionaryHunspell::encoding(const QString& aff)
+{
+	// Compressed affix files are only checked once they are loaded
+	QFile file(aff);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return QByteArray();
+	}
+
+	// Read encoding of affix file the same way as Hunspell
+	while (!file.atEnd()) {
+		QByteArray line = file.readLine().trimmed();
+		if (line.startsWith("\xEF\xBB\xBF")) {
+			line.remove(0, 3);
+		}
+		if (line.startsWith("SET") && (line.length() > 3) && QChar::isSpace(line.at(3))) {
+			return line.mid(4).trimmed();
+		}
+	}
+	return "ISO8859-1";
+}
+
+//-----------------------------------------------------------------------------
+
+void DictionaryHunspell::load(const QString& language, const QString& aff, const QString& dic)
+{
+	// Create dictionary
+#ifndef Q_WIN32
+	Hunspell* dictionary = new Hunspell(QFile::encodeName(aff).constData(), QFile::encodeName(dic).constData());
+#else
+	Hunspell* dictionary = new Hunspell( ("\\\\?\\" + QDir::toNativeSeparators(aff)).toUtf8().constData(),
+			("\\\\?\\" + QDir::toNativeSeparators(dic)).toUtf8().constData() );
+#endif
+	// Use a private codec because codecs are not safe to share between threads
+	TextCodec* codec = m_codec ? m_codec : TextCodec::createForName(dictionary->get_dic_encoding());
+	if (!codec) {
+		delete dictionary;
+
+		// Have dictionary manager replace dictionary
+		f_unsupported_mutex.lock();
+		f_unsupported.insert(language);
+		f_unsupported_mutex.unlock();
+		m_failed = true;
+		QMetaObject::invokeMethod(&DictionaryManager::instance(), &DictionaryManager::replaceInvalidDictionaries, Qt::QueuedConnection);
+		return;
+	}
+
+	// Add session words that were requested while dictionary was loading
+	QMutexLocker locker(&m_mutex);
+	for (const QString& word : std::as_const(m_session)) {
+		dictionary->add(codec->fromUnicode(word).constData());
+	}
+	m_session.clear();
+	m_dictionary = dictionary;
+	m_codec = codec;
+	m_loaded = true;
+	locker.unlock();
+
+	// Re-check documents
+	QMetaObject::invokeMethod(&DictionaryManager::instance(), &DictionaryManager::changed, Qt::QueuedConnection);
+}
+
+//-----------------------------------------------------------------------------
+
+bool DictionaryHunspell::spell(const QString& word) const
+{
+	const SpellingCache::Result cached = m_cache.lookup(word);
+	if (cached != SpellingCache::Unknown) {
+		return cached == SpellingCache::Correct;
+	}
+
+	QMutexLocker locker(&m_mutex);
+#ifdef H_DEPRECATED
+	const bool correct = m_dictionary->spell(m_codec->fromUnicode(word).toStdString());
+#else
+	const bool correct = m_dictionary->spell(m_codec->fromUnicode(word).constData());
+#endif
+	m_cache.insert(word, correct);
+	return correct;
 }
 
 }
@@ -10,6 +10,7 @@
 #include "dictionary_manager.h"
 #include "word_ref.h"
 
+#include <QMutex>
 #include <QVector>
 
 #import <AppKit/NSSpellChecker.h>
@@ -19,6 +20,10 @@
 
 //-----------------------------------------------------------------------------
 
+static QMutex f_spellchecker_mutex;
+
+//-----------------------------------------------------------------------------
+
 static NSArray* convertList(const QStringList& words)
 {
 	QVector<NSString*> strings;
@@ -90,6 +95,7 @@ WordRef DictionaryNSSpellChecker::check(const QString& string, int start_at) con
 
 	WordRef misspelled;
 
+	QMutexLocker locker(&f_spellchecker_mutex);
 	NSRange range = [[NSSpellChecker sharedSpellChecker] checkSpellingOfString:nsstring
 		startingAt:start_at
 		language:m_language
@@ -118,6 +124,7 @@ QStringList DictionaryNSSpellChecker::suggestions(const QString& word) const
 
 	NSString* nsstring = [NSString stringWithCharacters:reinterpret_cast<const unichar*>(word.unicode()) length:word.length()];
 
+	QMutexLocker locker(&f_spellchecker_mutex);
 	NSArray* array = [[NSSpellChecker sharedSpellChecker] guessesForWordRange:range
 		inString:nsstring
 		language:m_language
@@ -149,6 +156,7 @@ void DictionaryNSSpellChecker::addToSession(const QStringList& words)
 {
 	NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
 
+	QMutexLocker locker(&f_spellchecker_mutex);
 	[[NSSpellChecker sharedSpellChecker] setIgnoredWords:convertList(words) inSpellDocumentWithTag:m_tag];
 
 	[pool release];
@@ -160,6 +168,7 @@ void DictionaryNSSpellChecker::removeFromSession(const QStringList& words)
 {
 	NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
 
+	QMutexLocker locker(&f_spellchecker_mutex);
 	QStringList session;
 	NSArray* array = [[NSSpellChecker sharedSpellChecker] ignoredWordsInSpellDocumentWithTag:m_tag];
 	if (array) {
@@ -15,6 +15,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QLibrary>
+#include <QMutex>
 
 //-----------------------------------------------------------------------------
 
@@ -50,6 +51,7 @@ namespace
 	bool f_voikko_loaded = false;
 	QList<VoikkoHandle*> f_handles;
 	QByteArray f_voikko_path;
+	QMutex f_voikko_mutex;
 }
 
 //-----------------------------------------------------------------------------
@@ -96,6 +98,7 @@ DictionaryVoikko::DictionaryVoikko(const QString& language)
 	} else if (m_handle) {
 		voikkoSetBooleanOption(m_handle, VOIKKO_OPT_IGNORE_NUMBERS, f_ignore_numbers);
 		voikkoSetBooleanOption(m_handle, VOIKKO_OPT_IGNORE_UPPERCASE, f_ignore_uppercase);
+		QMutexLocker locker(&f_voikko_mutex);
 		f_handles.append(m_handle);
 	}
 }
@@ -105,6 +108,7 @@ DictionaryVoikko::DictionaryVoikko(const QString& language)
 DictionaryVoikko::~DictionaryVoikko()
 {
 	if (m_handle) {
+		QMutexLocker locker(&f_voikko_mutex);
 		f_handles.removeAll(m_handle);
 		voikkoTerminate(m_handle);
 	}
@@ -139,6 +143,7 @@ WordRef DictionaryVoikko::check(const QString& string, int start_at) const
 		}
 
 		if (is_word || (i == count && index != -1)) {
+			QMutexLocker locker(&f_voikko_mutex);
 			if (voikkoSpellCstr(m_handle, string.mid(index, length).toUtf8().constData()) != VOIKKO_SPELL_OK) {
 				return WordRef(index, length);
 			}
@@ -155,6 +160,7 @@ WordRef DictionaryVoikko::check(const QString& string, int start_at) const
 QStringList DictionaryVoikko::suggestions(const QString& word) const
 {
 	QStringList result;
+	QMutexLocker locker(&f_voikko_mutex);
 	char** suggestions = voikkoSuggestCstr(m_handle, word.toUtf8().constData());
 	if (suggestions) {
 		for (size_t i = 0; suggestions[i]; ++i) {
@@ -285,6 +291,7 @@ AbstractDictionary* DictionaryProviderVoikko::requestDictionary(const QString& l
 void DictionaryProviderVoikko::setIgnoreNumbers(bool ignore)
 {
 	f_ignore_numbers = ignore;
+	QMutexLocker locker(&f_voikko_mutex);
 	for (VoikkoHandle* handle : std::as_const(f_handles)) {
 		voikkoSetBooleanOption(handle, VOIKKO_OPT_IGNORE_NUMBERS, ignore);
 	}
@@ -295,6 +302,7 @@ void DictionaryProviderVoikko::setIgnoreNumbers(bool ignore)
 void DictionaryProviderVoikko::setIgnoreUppercase(bool ignore)
 {
 	f_ignore_uppercase = ignore;
+	QMutexLocker locker(&f_voikko_mutex);
 	for (VoikkoHandle* handle : std::as_const(f_handles)) {
 		voikkoSetBooleanOption(handle, VOIKKO_OPT_IGNORE_UPPERCASE, ignore);
 	}
@@ -14,6 +14,11 @@ class DictionaryManager;
 class DictionaryRef
 {
 public:
+	const AbstractDictionary* dictionary() const
+	{
+		return *d;
+	}
+
 	WordRef check(const QString& string, int start_at) const
 	{
 		return (*d)->check(string, start_at);
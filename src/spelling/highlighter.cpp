@@ -10,15 +10,34 @@
 #include "dictionary_ref.h"
 #include "spell_checker.h"
 
+#include <QtConcurrentMap>
 #include <QAction>
 #include <QContextMenuEvent>
 #include <QEvent>
 #include <QMenu>
 #include <QTextEdit>
+#include <QThread>
 #include <QTimer>
 
 //-----------------------------------------------------------------------------
 
+namespace
+{
+
+QList<WordRef> findMisspelled(const AbstractDictionary* dictionary, const QString& text)
+{
+	QList<WordRef> misspelled;
+	WordRef word;
+	while ((word = dictionary->check(text, word.position() + word.length())).isNull() == false) {
+		misspelled.append(word);
+	}
+	return misspelled;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
 Highlighter::Highlighter(QTextEdit* text, DictionaryRef& dictionary)
 	: QSyntaxHighlighter(text)
 	, m_dictionary(dictionary)
@@ -34,6 +53,9 @@ Highlighter::Highlighter(QTextEdit* text, DictionaryRef& dictionary)
 	m_spell_timer->setSingleShot(true);
 	connect(m_spell_timer, &QTimer::timeout, this, &Highlighter::updateSpelling);
 
+	m_spell_watcher = new QFutureWatcher<QList<WordRef>>(this);
+	connect(m_spell_watcher, &QFutureWatcher<QList<WordRef>>::finished, this, &Highlighter::spellingChecked);
+
 	m_text->installEventFilter(this);
 	m_text->viewport()->installEventFilter(this);
 	m_add_action = new QAction(tr("Add"), this);
@@ -42,6 +64,15 @@ Highlighter::Highlighter(QTextEdit* text, DictionaryRef& dictionary)
 
 //-----------------------------------------------------------------------------
 
+Highlighter::~Highlighter()
+{
+	// Workers use the dictionary, which may be deleted after this
+	m_spell_watcher->cancel();
+	m_spell_watcher->waitForFinished();
+}
+
+//-----------------------------------------------------------------------------
+
 void Highlighter::setEnabled(bool enabled)
 {
 	if (m_enabled != enabled) {
@@ -68,6 +99,21 @@ void Highlighter::setMisspelledColor(const QColor& color)
 
 //-----------------------------------------------------------------------------
 
+void Highlighter::setTextDocument(QTextDocument* document)
+{
+	// Forget blocks of previous document
+	m_spell_watcher->cancel();
+	m_spell_watcher->waitForFinished();
+	m_spell_blocks.clear();
+	m_current = QTextBlock();
+	m_cursor = QTextCursor();
+	m_start_cursor = QTextCursor();
+
+	setDocument(document);
+}
+
+//-----------------------------------------------------------------------------
+
 bool Highlighter::eventFilter(QObject* watched, QEvent* event)
 {
 	if (event->type() != QEvent::ContextMenu || !m_enabled || m_text->isReadOnly()) {
@@ -140,7 +186,8 @@ void Highlighter::highlightBlock(const QString& text)
 		return;
 	}
 	if (stats->spellingStatus() == BlockStats::CheckSpelling) {
-		stats->checkSpelling(text, m_dictionary);
+		// Keep showing previous misspellings until the block has been rechecked
+		m_spell_timer->start();
 	}
 
 	style.setUnderlineColor(m_misspelled);
@@ -166,34 +213,37 @@ void Highlighter::updateSpelling()
 		return;
 	}
 
-	const QTextBlock block = m_text->textCursor().block();
-	bool found = false;
-
-	// Check first unchecked block at or after cursor
-	for (QTextBlock i = block; i.isValid(); i = i.next()) {
-		BlockStats* stats = static_cast<BlockStats*>(i.userData());
-		if (stats && (stats->spellingStatus() != BlockStats::Checked)) {
-			stats->checkSpelling(i.text(), m_dictionary);
-			rehighlightBlock(i);
-			found = true;
-			break;
-		}
+	// Remaining blocks are queued after the current blocks have been checked
+	if (m_spell_watcher->isRunning()) {
+		return;
 	}
 
-	// Check first unchecked block before cursor
-	for (QTextBlock i = block; i.isValid(); i = i.previous()) {
-		BlockStats* stats = static_cast<BlockStats*>(i.userData());
-		if (stats && (stats->spellingStatus() != BlockStats::Checked)) {
-			stats->checkSpelling(i.text(), m_dictionary);
-			rehighlightBlock(i);
-			found = true;
-			break;
+	// Snapshot unchecked blocks nearest to cursor
+	const int max_characters = 16384 * QThread::idealThreadCount();
+	int characters = 0;
+	QStringList texts;
+	m_spell_blocks.clear();
+
+	const QTextBlock block = m_text->textCursor().block();
+	QTextBlock next = block;
+	QTextBlock previous = block.previous();
+	while ((next.isValid() || previous.isValid()) && (characters < max_characters)) {
+		if (next.isValid()) {
+			characters += queueSpelling(next, texts);
+			next = next.next();
+		}
+		if (previous.isValid()) {
+			characters += queueSpelling(previous, texts);
+			previous = previous.previous();
 		}
 	}
 
-	// Repeat until all blocks have been checked
-	if (found) {
-		m_spell_timer->start();
+	// Check blocks in other threads
+	if (!texts.isEmpty()) {
+		const AbstractDictionary* dictionary = m_dictionary.dictionary();
+		m_spell_watcher->setFuture(QtConcurrent::mapped(texts, [dictionary](const QString& text) {
+			return findMisspelled(dictionary, text);
+		}));
 	}
 }
 
@@ -214,6 +264,28 @@ void Highlighter::cursorPositionChanged()
 
 //-----------------------------------------------------------------------------
 
+void Highlighter::spellingChecked()
+{
+	// Apply results to blocks that have not changed since they were queued
+	if (!m_spell_watcher->isCanceled()) {
+		const QList<QList<WordRef>> results = m_spell_watcher->future().results();
+		for (int i = 0, count = results.count(); i < count; ++i) {
+			const QTextBlock block = document()->findBlockByNumber(m_spell_blocks.at(i).first);
+			BlockStats* stats = static_cast<BlockStats*>(block.userData());
+			if (stats && (stats->revision() == m_spell_blocks.at(i).second)) {
+				stats->setMisspelled(results.at(i));
+				rehighlightBlock(block);
+			}
+		}
+	}
+	m_spell_blocks.clear();
+
+	// Check any blocks that were skipped or changed
+	updateSpelling();
+}
+
+//-----------------------------------------------------------------------------
+
 void Highlighter::suggestion(QAction* action)
 {
 	if (action == m_add_action) {
@@ -228,3 +300,23 @@ void Highlighter::suggestion(QAction* action)
 }
 
 //-----------------------------------------------------------------------------
+
+int Highlighter::queueSpelling(const QTextBlock& block, QStringList& texts)
+{
+	BlockStats* stats = static_cast<BlockStats*>(block.userData());
+	if (!stats || (stats->spellingStatus() == BlockStats::Checked)) {
+		return 0;
+	}
+
+	const QString text = block.text();
+	if (text.isEmpty()) {
+		stats->setMisspelled(QList<WordRef>());
+		return 0;
+	}
+
+	texts.append(text);
+	m_spell_blocks.append(qMakePair(block.blockNumber(), stats->revision()));
+	return text.length();
+}
+
+//-----------------------------------------------------------------------------
@@ -7,8 +7,10 @@
 #ifndef FOCUSWRITER_HIGHLIGHTER_H
 #define FOCUSWRITER_HIGHLIGHTER_H
 
+#include "word_ref.h"
 class DictionaryRef;
 
+#include <QFutureWatcher>
 #include <QSyntaxHighlighter>
 #include <QTextCursor>
 class QAction;
@@ -21,10 +23,12 @@ class Highlighter : public QSyntaxHighlighter
 
 public:
 	Highlighter(QTextEdit* text, DictionaryRef& dictionary);
+	~Highlighter();
 
 	bool enabled() const;
 	void setEnabled(bool enabled);
 	void setMisspelledColor(const QColor& color);
+	void setTextDocument(QTextDocument* document);
 
 	bool eventFilter(QObject* watched, QEvent* event) override;
 	void highlightBlock(const QString& text) override;
@@ -34,11 +38,17 @@ public Q_SLOTS:
 
 private Q_SLOTS:
 	void cursorPositionChanged();
+	void spellingChecked();
 	void suggestion(QAction* action);
 
+private:
+	int queueSpelling(const QTextBlock& block, QStringList& texts);
+
 private:
 	DictionaryRef& m_dictionary;
 	QTimer* m_spell_timer;
+	QFutureWatcher<QList<WordRef>>* m_spell_watcher;
+	QList<QPair<int, unsigned int>> m_spell_blocks;
 	QTextEdit* m_text;
 	QTextCursor m_cursor;
 	QTextCursor m_start_cursor;
@@ -0,0 +1,98 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "spelling_cache.h"
+
+//-----------------------------------------------------------------------------
+
+SpellingCache::SpellingCache(int max_words)
+	: m_max_words(max_words / 2)
+	, m_hits(0)
+	, m_misses(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+SpellingCache::Result SpellingCache::lookup(const QString& word)
+{
+	QReadLocker locker(&m_lock);
+
+	const auto i = m_current.constFind(word);
+	if (i != m_current.constEnd()) {
+		++m_hits;
+		return i.value() ? Correct : Incorrect;
+	}
+	if (!m_previous.contains(word)) {
+		++m_misses;
+		return Unknown;
+	}
+	locker.unlock();
+
+	// Move word into current generation so that words still in use are not discarded
+	QWriteLocker writer(&m_lock);
+	const auto previous = m_previous.constFind(word);
+	if (previous == m_previous.constEnd()) {
+		++m_misses;
+		return Unknown;
+	}
+	const bool correct = previous.value();
+	add(word, correct);
+
+	++m_hits;
+	return correct ? Correct : Incorrect;
+}
+
+//-----------------------------------------------------------------------------
+
+int SpellingCache::count() const
+{
+	QReadLocker locker(&m_lock);
+	return m_current.count() + m_previous.count();
+}
+
+//-----------------------------------------------------------------------------
+
+void SpellingCache::insert(const QString& word, bool correct)
+{
+	QWriteLocker locker(&m_lock);
+	add(word, correct);
+}
+
+//-----------------------------------------------------------------------------
+
+void SpellingCache::add(const QString& word, bool correct)
+{
+	// Start a new generation of words, discarding the oldest generation
+	if (m_current.count() >= m_max_words) {
+		m_previous.swap(m_current);
+		m_current.clear();
+	}
+	m_current.insert(word, correct);
+}
+
+//-----------------------------------------------------------------------------
+
+void SpellingCache::remove(const QStringList& words)
+{
+	QWriteLocker locker(&m_lock);
+
+	for (const QString& word : words) {
+		if (word.isEmpty()) {
+			continue;
+		}
+
+		// Dictionaries also accept the capitalized and uppercase forms of words
+		QString title = word;
+		title[0] = title.at(0).toTitleCase();
+		for (const QString& form : { word, title, word.toUpper() }) {
+			m_current.remove(form);
+			m_previous.remove(form);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
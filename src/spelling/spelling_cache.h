@@ -0,0 +1,58 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef FOCUSWRITER_SPELLING_CACHE_H
+#define FOCUSWRITER_SPELLING_CACHE_H
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QStringList>
+
+#include <atomic>
+
+class SpellingCache
+{
+public:
+	explicit SpellingCache(int max_words = 65536);
+
+	enum Result
+	{
+		Unknown,
+		Correct,
+		Incorrect
+	};
+	Result lookup(const QString& word);
+
+	int count() const;
+	quint64 hits() const;
+	quint64 misses() const;
+
+	void insert(const QString& word, bool correct);
+	void remove(const QStringList& words);
+
+private:
+	void add(const QString& word, bool correct);
+
+private:
+	QHash<QString, bool> m_current;
+	QHash<QString, bool> m_previous;
+	int m_max_words;
+	mutable QReadWriteLock m_lock;
+	mutable std::atomic<quint64> m_hits;
+	mutable std::atomic<quint64> m_misses;
+};
+
+inline quint64 SpellingCache::hits() const
+{
+	return m_hits;
+}
+
+inline quint64 SpellingCache::misses() const
+{
+	return m_misses;
+}
+
+#endif // FOCUSWRITER_SPELLING_CACHE_H
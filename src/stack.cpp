@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2009-2020 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2009-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -160,9 +160,29 @@ void Stack::moveDocument(int from, int to)
 
 //-----------------------------------------------------------------------------
 
+void Stack::openDocument(const QString& filename)
+{
+	Q_EMIT documentRequested(filename);
+}
+
+//-----------------------------------------------------------------------------
+
+void Stack::showDocument(const Document* document)
+{
+	for (int i = 0, count = m_documents.count(); i < count; ++i) {
+		if (m_documents.at(i) == document) {
+			Q_EMIT documentSelected(i);
+			break;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
 void Stack::removeDocument(int index)
 {
 	Document* document = m_documents.takeAt(index);
+	m_recent_documents.removeOne(document);
 	m_contents->removeWidget(document);
 
 	QAction* action = m_document_actions.takeAt(index);
@@ -176,6 +196,28 @@ void Stack::removeDocument(int index)
 
 //-----------------------------------------------------------------------------
 
+void Stack::releaseDocuments()
+{
+	// Keep recently used documents loaded until memory limit is reached
+	qint64 available = qint64(Preferences::instance().backgroundMemory()) * 1024 * 1024;
+	for (int i = m_recent_documents.count() - 1; i >= 0; --i) {
+		Document* document = m_recent_documents.at(i);
+		if ((document == m_current_document) || document->isDormant()) {
+			continue;
+		}
+
+		const qint64 usage = document->memoryUsage();
+		if (usage <= available) {
+			available -= usage;
+		} else {
+			available = 0;
+			document->sleep();
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
 void Stack::updateDocument(int index)
 {
 	const Document* document = m_documents.at(index);
@@ -186,9 +228,19 @@ void Stack::updateDocument(int index)
 
 //-----------------------------------------------------------------------------
 
-void Stack::setCurrentDocument(int index)
+bool Stack::setCurrentDocument(int index)
 {
-	m_current_document = m_documents[index];
+	// Leave current document alone if file can not be read again
+	Document* document = m_documents[index];
+	if (!document->wake()) {
+		return false;
+	}
+
+	m_current_document = document;
+	m_recent_documents.removeOne(m_current_document);
+	m_recent_documents.append(m_current_document);
+	releaseDocuments();
+
 	m_contents->setCurrentWidget(m_current_document);
 	m_scenes->setDocument(m_current_document);
 	m_document_actions[index]->setChecked(true);
@@ -197,6 +249,9 @@ void Stack::setCurrentDocument(int index)
 	Q_EMIT redoAvailable(m_current_document->text()->document()->isRedoAvailable());
 	Q_EMIT undoAvailable(m_current_document->text()->document()->isUndoAvailable());
 	Q_EMIT updateFormatActions();
+	Q_EMIT currentDocumentChanged();
+
+	return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -270,9 +325,7 @@ void Stack::alignRight()
 void Stack::autoCache()
 {
 	for (Document* document : std::as_const(m_documents)) {
-		if (document->isModified()) {
-			document->cache();
-		}
+		document->cache();
 	}
 }
 
@@ -399,7 +452,7 @@ void Stack::replace()
 
 void Stack::save()
 {
-	m_current_document->save();
+	m_current_document->startSave();
 }
 
 //-----------------------------------------------------------------------------
@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2009-2019 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2009-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -40,11 +40,15 @@ public:
 	Document* currentDocument() const;
 	int currentIndex() const;
 	Document* document(int index) const;
+	const Theme& theme() const;
 
 	void moveDocument(int from, int to);
+	void openDocument(const QString& filename);
+	void showDocument(const Document* document);
 	void removeDocument(int index);
+	void releaseDocuments();
 	void updateDocument(int index);
-	void setCurrentDocument(int index);
+	bool setCurrentDocument(int index);
 	void setMargins(int footer, int header);
 	void waitForThemeBackground();
 
@@ -59,6 +63,8 @@ Q_SIGNALS:
 	void documentAdded(Document* document);
 	void documentRemoved(Document* document);
 	void documentSelected(int index);
+	void documentRequested(const QString& filename);
+	void currentDocumentChanged();
 	void findNextAvailable(bool available);
 	void updateFormatActions();
 	void updateFormatAlignmentActions();
@@ -138,6 +144,7 @@ private:
 	QStackedWidget* m_contents;
 	QList<Document*> m_documents;
 	QList<QAction*> m_document_actions;
+	QList<Document*> m_recent_documents;
 	Document* m_current_document;
 
 	ThemeRenderer* m_theme_renderer;
@@ -187,4 +194,9 @@ inline Document* Stack::document(int index) const
 	return m_documents[index];
 }
 
+inline const Theme& Stack::theme() const
+{
+	return m_theme;
+}
+
 #endif // FOCUSWRITER_STACK_H
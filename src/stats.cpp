@@ -65,6 +65,18 @@ void Stats::append(const BlockStats* block)
 
 //-----------------------------------------------------------------------------
 
+void Stats::append(const Stats& stats)
+{
+	m_valid = true;
+	m_character_count += stats.m_character_count;
+	m_letter_count += stats.m_letter_count;
+	m_paragraph_count += stats.m_paragraph_count;
+	m_space_count += stats.m_space_count;
+	m_word_count += stats.m_word_count;
+}
+
+//-----------------------------------------------------------------------------
+
 void Stats::calculatePageCount(int type, float page_amount)
 {
 	float amount = 0;
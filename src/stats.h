@@ -24,6 +24,7 @@ public:
 	int wordCount() const;
 
 	void append(const BlockStats* block);
+	void append(const Stats& stats);
 	void calculatePageCount(int type, float page_amount);
 	void calculateWordCount(int type);
 	void clear();
@@ -190,23 +190,11 @@ public:
 			return codec;
 		}
 
-		codec = new TextCodec(name);
-		if (codec->isValid()) {
-			m_codecs.insert(name, codec);
-			return codec;
-		} else {
-			delete codec;
-		}
-
-		codec = new TextCodecIconv(name);
-		if (codec->isValid()) {
+		codec = TextCodec::createForName(name);
+		if (codec) {
 			m_codecs.insert(name, codec);
-			return codec;
-		} else {
-			delete codec;
 		}
-
-		return nullptr;
+		return codec;
 	}
 
 private:
@@ -224,3 +212,24 @@ TextCodec* TextCodec::codecForName(const QByteArray& name)
 }
 
 //-----------------------------------------------------------------------------
+
+TextCodec* TextCodec::createForName(const QByteArray& name)
+{
+	TextCodec* codec = new TextCodec(name);
+	if (codec->isValid()) {
+		return codec;
+	} else {
+		delete codec;
+	}
+
+	codec = new TextCodecIconv(name);
+	if (codec->isValid()) {
+		return codec;
+	} else {
+		delete codec;
+	}
+
+	return nullptr;
+}
+
+//-----------------------------------------------------------------------------
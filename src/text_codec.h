@@ -42,6 +42,7 @@ public:
 	}
 
 	static TextCodec* codecForName(const QByteArray& name);
+	static TextCodec* createForName(const QByteArray& name);
 
 private:
 	QStringDecoder m_decoder;
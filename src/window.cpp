@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2008-2025 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2008-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -15,6 +15,7 @@
 #include "dictionary_dialog.h"
 #include "document.h"
 #include "document_cache.h"
+#include "document_reader.h"
 #include "document_watcher.h"
 #include "format_manager.h"
 #include "load_screen.h"
@@ -33,12 +34,15 @@
 #include "timer_manager.h"
 #include "utils.h"
 
+#include <QtConcurrentRun>
 #include <QAction>
 #include <QActionGroup>
 #include <QApplication>
 #include <QCloseEvent>
+#include <QEventLoop>
 #include <QFileDialog>
 #include <QFileOpenEvent>
+#include <QFutureWatcher>
 #include <QGridLayout>
 #include <QIcon>
 #include <QLabel>
@@ -49,6 +53,7 @@
 #include <QMimeData>
 #include <QPlainTextEdit>
 #include <QScrollBar>
+#include <QSet>
 #include <QSettings>
 #include <QSizeGrip>
 #include <QStandardPaths>
@@ -80,6 +85,8 @@ QKeySequence keyBinding(const QKeySequence& shortcut, const QKeySequence& back)
 Window::Window(const QStringList& command_line_files)
 	: m_toolbar(nullptr)
 	, m_loading(false)
+	, m_loading_attaching(0)
+	, m_loading_count(0)
 	, m_key_sound(nullptr)
 	, m_enter_key_sound(nullptr)
 	, m_fullscreen(true)
@@ -134,6 +141,7 @@ Window::Window(const QStringList& command_line_files)
 	// Create documents
 	m_documents = new Stack(this);
 	m_document_cache->setOrdering(m_documents);
+	connect(m_document_cache, &DocumentCache::cacheFailed, this, &Window::cacheFailed);
 	m_sessions = new SessionManager(this);
 	m_timers = new TimerManager(m_documents, this);
 	connect(m_documents, &Stack::footerVisible, m_timers->display(), &TimerDisplay::setVisible);
@@ -153,10 +161,13 @@ Window::Window(const QStringList& command_line_files)
 	// Set up menubar and toolbar
 	initMenus();
 
-	// Set up cache timer
+	// Set up cache timers
+	m_cache_timer = new QTimer(this);
+	m_cache_timer->setInterval(5000);
+	connect(m_cache_timer, &QTimer::timeout, m_documents, &Stack::autoCache);
+
 	m_save_timer = new QTimer(this);
 	m_save_timer->setInterval(300000);
-	connect(m_save_timer, &QTimer::timeout, m_documents, &Stack::autoCache);
 	connect(m_save_timer, &QTimer::timeout, m_daily_progress, &DailyProgress::save);
 
 	// Set up details
@@ -191,6 +202,7 @@ Window::Window(const QStringList& command_line_files)
 	connect(m_tabs, &QTabBar::tabCloseRequested, this, &Window::tabClosed);
 	connect(m_tabs, &QTabBar::tabMoved, this, &Window::tabMoved);
 	connect(m_documents, &Stack::documentSelected, m_tabs, &QTabBar::setCurrentIndex);
+	connect(m_documents, &Stack::documentRequested, this, qOverload<const QString&>(&Window::addDocuments));
 
 	QToolButton* tabs_menu = new QToolButton(m_tabs);
 	tabs_menu->setArrowType(Qt::UpArrow);
@@ -364,6 +376,7 @@ Window::Window(const QStringList& command_line_files)
 	raise();
 	unsetCursor();
 
+	m_cache_timer->start();
 	m_save_timer->start();
 }
 
@@ -371,6 +384,10 @@ Window::Window(const QStringList& command_line_files)
 
 void Window::addDocuments(const QStringList& files, const QStringList& datafiles, const QStringList& positions, int active, bool show_load)
 {
+	// Finish adding files that are still being read in background
+	if (m_loading) {
+		waitForLoads();
+	}
 	m_loading = true;
 
 	// Hide interface
@@ -417,56 +434,65 @@ void Window::addDocuments(const QStringList& files, const QStringList& datafiles
 		}
 	}
 
-	// Read files
-	QStringList missing;
-	QStringList errors;
-	QStringList readonly;
-	int open_files = m_documents->count();
+	// Choose which copy of each file to read
+	QSet<QString> opened;
+	for (int i = 0, count = m_documents->count(); i < count; ++i) {
+		opened.insert(QFileInfo(m_documents->document(i)->filename()).canonicalFilePath());
+	}
+	QStringList paths;
 	for (int i = 0, count = files.count(); i < count; ++i) {
-		// Skip file known to be unsupported
-		if (!skip.isEmpty() && (skip.constFirst() == i)) {
-			skip.removeFirst();
-			continue;
-		// Attempt to load file or datafile
-		} else if (!addDocument(files.at(i), datafiles.at(i), positions.value(i, "-1").toInt())) {
-			// Track if unable to open file
-			missing.append(QDir::toNativeSeparators(files.at(i)));
-		} else if (!files.at(i).isEmpty() && (m_documents->currentDocument()->untitledIndex() > 0)) {
-			// Track if unable to read file
-			const int index = m_documents->currentIndex();
-			errors.append(QDir::toNativeSeparators(files.at(i)));
-			closeDocument(index, true);
-		} else if (m_documents->currentDocument()->isReadOnly() && (m_documents->count() > open_files)) {
-			// Track if file is read-only and not already open
-			readonly.append(QDir::toNativeSeparators(files.at(i)));
+		QString path;
+		if (files.at(i).isEmpty()) {
+			path = datafiles.at(i);
+		} else if (!skip.contains(i)) {
+			const QFileInfo info(files.at(i));
+			const QString canonical_filename = info.canonicalFilePath();
+			if (info.exists() && info.isReadable() && !opened.contains(canonical_filename)) {
+				opened.insert(canonical_filename);
+				path = chooseFile(files.at(i), datafiles.at(i));
+			}
 		}
-		open_files = m_documents->count();
+		paths.append(path);
 	}
 
-	// Make sure that there is always at least one document
-	if (m_documents->count() == 0) {
-		newDocument();
+	// Start reading files in separate threads, beginning with file that is shown first
+	int first = active - m_documents->count();
+	if ((first < 0) || (first >= files.count())) {
+		first = files.count() - 1;
 	}
-
-	// Switch to tab of active session file or of current file
-	if (untitled_index == -1) {
-		if (active != -1) {
-			m_tabs->setCurrentIndex(active);
-		} else if (m_documents->currentIndex() == current_index) {
-			m_tabs->setCurrentIndex(m_tabs->count() - 1);
+	m_loading_count = files.count();
+	m_loading_slots = QList<QPointer<Document>>(files.count());
+	m_loading_untitled = (untitled_index != -1) ? m_documents->document(untitled_index) : nullptr;
+	QList<int> order;
+	for (int i = 0, count = files.count(); i < count; ++i) {
+		if (!skip.contains(i)) {
+			order.append(i);
+		}
+	}
+	if (order.removeOne(first)) {
+		order.prepend(first);
+	}
+	for (int slot : std::as_const(order)) {
+		LoadingFile loading;
+		loading.slot = slot;
+		loading.file = files.at(slot);
+		loading.datafile = datafiles.at(slot);
+		loading.position = positions.value(slot, "-1").toInt();
+		if (!paths.at(slot).isEmpty()) {
+			loading.preload = preloadFile(loading.file, loading.datafile, paths.at(slot));
 		}
-	// Replace current tab if it is untitled and unmodified
-	} else if (files.count() > (missing.count() + errors.count())) {
-		m_tabs->setCurrentIndex(untitled_index);
-		closeDocument();
+		m_loading_files.append(loading);
 	}
 
-	// Inform user about unopened and read-only files
-	if (!missing.isEmpty()) {
-		m_documents->alerts()->addAlert(new Alert(Alert::Warning, tr("Some files could not be opened."), missing, true));
+	// Show first file as soon as it has been read
+	if (!m_loading_files.isEmpty() && (m_loading_files.constFirst().slot == first)) {
+		attachDocument(m_loading_files.takeFirst(), true);
 	}
-	if (!readonly.isEmpty()) {
-		m_documents->alerts()->addAlert(new Alert(Alert::Information, tr("Some files were opened Read-Only."), readonly, true));
+
+	// Make sure that there is always at least one document
+	if (m_documents->count() == 0) {
+		newDocument();
+		m_loading_untitled = m_documents->currentDocument();
 	}
 
 	// Hide load screen
@@ -476,13 +502,22 @@ void Window::addDocuments(const QStringList& files, const QStringList& datafiles
 		unsetCursor();
 	}
 
-	// Open any files queued during load
-	if (!m_queued_documents.isEmpty()) {
-		const QStringList queued = m_queued_documents;
-		m_queued_documents.clear();
-		addDocuments(queued, queued);
+	// Add other files in background as they finish being read
+	for (const LoadingFile& loading : std::as_const(m_loading_files)) {
+		if (loading.preload.reader) {
+			QFutureWatcher<void>* watcher = new QFutureWatcher<void>(this);
+			connect(watcher, &QFutureWatcherBase::finished, this, &Window::attachLoadedDocuments);
+			connect(watcher, &QFutureWatcherBase::finished, watcher, &QObject::deleteLater);
+			watcher->setFuture(loading.preload.reader->future());
+		}
+		if (loading.preload.unchanged.isValid()) {
+			QFutureWatcher<bool>* watcher = new QFutureWatcher<bool>(this);
+			connect(watcher, &QFutureWatcherBase::finished, this, &Window::attachLoadedDocuments);
+			connect(watcher, &QFutureWatcherBase::finished, watcher, &QObject::deleteLater);
+			watcher->setFuture(loading.preload.unchanged);
+		}
 	}
-	m_loading = false;
+	attachLoadedDocuments();
 }
 
 //-----------------------------------------------------------------------------
@@ -521,6 +556,7 @@ bool Window::closeDocuments(QSettings* session)
 
 bool Window::saveDocuments(QSettings* session)
 {
+	waitForLoads();
 	if (m_documents->count() == 0) {
 		return true;
 	}
@@ -529,21 +565,31 @@ bool Window::saveDocuments(QSettings* session)
 	const int active = m_tabs->currentIndex();
 	QStringList files;
 	QStringList positions;
+	QList<Document*> saving;
 	for (int i = 0, count = m_documents->count(); i < count; ++i) {
 		m_tabs->setCurrentIndex(i);
-		if (!saveDocument(i)) {
+		if (!saveDocument(i, true)) {
 			m_tabs->setCurrentIndex(active);
 			return false;
 		}
 
 		Document* document = m_documents->document(i);
+		if (document->isSaving()) {
+			saving.append(document);
+		}
 		const QString filename = document->filename();
 		if (!filename.isEmpty()) {
 			files.append(filename);
-			positions.append(QString::number(document->text()->textCursor().position()));
+			positions.append(QString::number(document->cursorPosition()));
 		}
 	}
 
+	// Wait for files to be written
+	if (!waitForSaves(saving)) {
+		m_tabs->setCurrentIndex(active);
+		return false;
+	}
+
 	// Store current files
 	session->setValue("Save/Current", files);
 	session->setValue("Save/Positions", positions);
@@ -695,17 +741,24 @@ void Window::renameDocument()
 
 void Window::saveAllDocuments()
 {
+	// Write named files in background while untitled files prompt for names
 	const int index = m_tabs->currentIndex();
+	QList<Document*> saving;
 	for (int i = 0, count = m_documents->count(); i < count; ++i) {
 		Document* document = m_documents->document(i);
 		if (!document->filename().isEmpty()) {
-			document->save();
+			document->startSave();
+			if (document->isSaving()) {
+				saving.append(document);
+			}
 		} else {
 			m_tabs->setCurrentIndex(i);
 			document->saveAs();
 		}
 	}
 	m_tabs->setCurrentIndex(index);
+
+	waitForSaves(saving);
 }
 
 //-----------------------------------------------------------------------------
@@ -732,6 +785,18 @@ void Window::closeDocument(const Document* document)
 
 //-----------------------------------------------------------------------------
 
+void Window::cacheFailed(const Document* document)
+{
+	for (int i = 0, count = m_documents->count(); i < count; ++i) {
+		if (m_documents->document(i) == document) {
+			m_documents->document(i)->cacheFailed();
+			break;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
 void Window::showDocument(const Document* document)
 {
 	for (int i = 0, count = m_documents->count(); i < count; ++i) {
@@ -884,8 +949,14 @@ void Window::tabClicked(int index)
 	if (m_documents->count() == 0) {
 		return;
 	}
+
+	// Close document that could not be read again, so that what was read can not overwrite file
+	if (!m_documents->setCurrentDocument(index)) {
+		closeDocument(index);
+		return;
+	}
+
 	updateWriteState(index);
-	m_documents->setCurrentDocument(index);
 	updateDetails();
 	updateSave();
 	updateFormatAlignmentActions();
@@ -905,8 +976,10 @@ void Window::tabClosed(int index)
 void Window::tabMoved(int from, int to)
 {
 	m_documents->moveDocument(from, to);
-	m_documents->setCurrentDocument(m_tabs->currentIndex());
 	m_document_cache->updateMapping();
+	if (!m_documents->setCurrentDocument(m_tabs->currentIndex())) {
+		closeDocument(m_tabs->currentIndex());
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -996,7 +1069,7 @@ void Window::updateSave()
 
 //-----------------------------------------------------------------------------
 
-bool Window::addDocument(const QString& file, const QString& datafile, int position)
+bool Window::addDocument(const QString& file, const QString& datafile, int position, const PreloadedFile& preload)
 {
 	const QFileInfo info(file);
 	if (!file.isEmpty()) {
@@ -1015,8 +1088,9 @@ bool Window::addDocument(const QString& file, const QString& datafile, int posit
 		}
 	}
 
-	// Show filename in load screen
-	const bool show_load = !file.isEmpty() && !m_load_screen->isVisible() && (info.size() > 100000);
+	// Show filename in load screen if file still has to be read
+	const bool read = preload.reader && preload.reader->future().isFinished();
+	const bool show_load = !file.isEmpty() && !m_load_screen->isVisible() && (info.size() > 100000) && !read;
 	if (m_load_screen->isVisible() || show_load) {
 		if (!file.isEmpty()) {
 			m_load_screen->setText(tr("Opening %1").arg(QDir::toNativeSeparators(file)));
@@ -1026,38 +1100,45 @@ bool Window::addDocument(const QString& file, const QString& datafile, int posit
 	}
 
 	// Create document
-	QString path = file;
-	if (!file.isEmpty() && (datafile != file)) {
-		if (QFileInfo(datafile).lastModified() > QFileInfo(file).lastModified()) {
-			path = datafile;
-			position = -1;
-		} else {
-			QMessageBox mbox(window());
-			mbox.setWindowTitle(tr("Warning"));
-			mbox.setText(tr("'%1' is newer than the cached copy.").arg(file));
-			mbox.setInformativeText(tr("Overwrite newer file?"));
-			mbox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
-			mbox.setDefaultButton(QMessageBox::No);
-			mbox.setIcon(QMessageBox::Warning);
-			if (mbox.exec() == QMessageBox::Yes) {
-				path = datafile;
-				position = -1;
-			}
-		}
-	} else {
-		path = datafile;
+	const PreloadedFile load = preload.path.isEmpty() ? preloadFile(file, datafile, chooseFile(file, datafile)) : preload;
+	if (!file.isEmpty() && (load.path != file)) {
+		position = -1;
 	}
 	Document* document = new Document(file, m_daily_progress, this);
 	m_documents->addDocument(document);
 	m_document_cache->add(document);
 	document->setFocusMode(m_focus_actions->checkedAction()->data().toInt());
-	if (document->loadFile(path, m_save_positions ? position : -1)) {
+	connect(document, &Document::loadProgress, m_load_screen, &LoadScreen::setProgress);
+	const QMetaObject::Connection cancel = connect(m_load_screen, &LoadScreen::cancelled, document, &Document::cancelLoad);
+	const bool cancellable = m_load_screen->isVisible();
+	bool loaded = false;
+	if (load.reader) {
+		loaded = document->loadFile(load.reader, m_save_positions ? position : -1, cancellable);
+	} else {
+		loaded = document->loadFile(load.path, m_save_positions ? position : -1, cancellable);
+	}
+	if (loaded) {
 		if (datafile != file) {
-			document->setModified(!compareFiles(file, datafile));
+			document->setModified(!load.unchanged.result());
+		}
+	} else if ((load.path != file) && !document->isLoadCancelled()) {
+		document->loadFile(file, m_save_positions ? position : -1, cancellable);
+	}
+	disconnect(cancel);
+
+	// Discard document if loading was cancelled
+	if (document->isLoadCancelled()) {
+		m_document_cache->remove(document);
+		m_documents->removeDocument(m_documents->count() - 1);
+		if (m_tabs->count() && !m_documents->setCurrentDocument(m_tabs->currentIndex())) {
+			closeDocument(m_tabs->currentIndex());
+		}
+		if (show_load) {
+			m_load_screen->finish();
 		}
-	} else if (path != file) {
-		document->loadFile(file, m_save_positions ? position : -1);
+		return true;
 	}
+
 	connect(document, &Document::changed, this, &Window::updateDetails);
 	connect(document, &Document::changedName, this, &Window::updateSave);
 	connect(document, &Document::indentChanged, m_actions["FormatIndentDecrease"], &QAction::setEnabled);
@@ -1072,9 +1153,15 @@ bool Window::addDocument(const QString& file, const QString& datafile, int posit
 		m_load_screen->finish();
 	}
 
-	// Allow documents to show load screen on reload
+	// Allow documents to show load screen on reload, which can only cancel loading of that document
 	connect(document, &Document::loadStarted, m_load_screen, &LoadScreen::setText);
+	connect(document, &Document::loadStarted, this, [this, document] {
+		connect(m_load_screen, &LoadScreen::cancelled, document, &Document::cancelLoad, Qt::UniqueConnection);
+	});
 	connect(document, &Document::loadFinished, m_load_screen, &LoadScreen::finish);
+	connect(document, &Document::loadFinished, this, [this, document] {
+		disconnect(m_load_screen, &LoadScreen::cancelled, document, &Document::cancelLoad);
+	});
 	connect(document, &Document::loadFinished, this, &Window::updateSave);
 
 	return true;
@@ -1082,6 +1169,174 @@ bool Window::addDocument(const QString& file, const QString& datafile, int posit
 
 //-----------------------------------------------------------------------------
 
+void Window::attachDocument(const LoadingFile& loading, bool show)
+{
+	++m_loading_attaching;
+
+	// Attempt to load file or datafile
+	Document* current = m_documents->currentDocument();
+	const int open_files = m_documents->count();
+	if (!addDocument(loading.file, loading.datafile, loading.position, loading.preload)) {
+		// Track if unable to open file
+		m_loading_missing.append(QDir::toNativeSeparators(loading.file));
+	} else if (m_documents->count() == open_files) {
+		// Skip file that was already open or whose loading was cancelled
+	} else if (!loading.file.isEmpty() && (m_documents->currentDocument()->untitledIndex() > 0)) {
+		// Track if unable to read file
+		m_loading_errors.append(QDir::toNativeSeparators(loading.file));
+		closeDocument(m_documents->currentIndex(), true);
+	} else {
+		// Track if file is read-only
+		Document* document = m_documents->currentDocument();
+		if (document->isReadOnly()) {
+			m_loading_readonly.append(QDir::toNativeSeparators(loading.file));
+		}
+
+		// Move tab in front of files that come after it
+		m_loading_slots[loading.slot] = document;
+		const int index = m_documents->currentIndex();
+		int next = index;
+		for (int slot = loading.slot + 1, count = m_loading_slots.count(); (slot < count) && (next == index); ++slot) {
+			for (int i = 0; i < index; ++i) {
+				if (m_loading_slots.at(slot) == m_documents->document(i)) {
+					next = i;
+					break;
+				}
+			}
+		}
+		if (next != index) {
+			m_tabs->moveTab(index, next);
+		}
+	}
+
+	// Stay on document that was current
+	if (!show && current) {
+		for (int i = 0, count = m_documents->count(); i < count; ++i) {
+			if (m_documents->document(i) == current) {
+				m_tabs->setCurrentIndex(i);
+				break;
+			}
+		}
+	}
+
+	--m_loading_attaching;
+}
+
+//-----------------------------------------------------------------------------
+
+void Window::attachLoadedDocuments()
+{
+	// Wait until current file has been added
+	if (m_loading_attaching) {
+		return;
+	}
+
+	// Add files in order once they have been read
+	for (int i = 0; i < m_loading_files.count();) {
+		const PreloadedFile& preload = m_loading_files.at(i).preload;
+		if ((!preload.reader || preload.reader->future().isFinished()) && preload.unchanged.isFinished()) {
+			attachDocument(m_loading_files.takeAt(i), false);
+			i = 0;
+		} else {
+			++i;
+		}
+	}
+
+	if (m_loading && m_loading_files.isEmpty()) {
+		finishLoading();
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void Window::finishLoading()
+{
+	// Replace untitled document if it is unmodified and files were opened
+	if (m_loading_untitled && !m_loading_untitled->isModified()
+			&& (m_loading_count > (m_loading_missing.count() + m_loading_errors.count()))
+			&& (m_documents->count() > 1)) {
+		for (int i = 0, count = m_documents->count(); i < count; ++i) {
+			if (m_documents->document(i) == m_loading_untitled) {
+				closeDocument(i);
+				break;
+			}
+		}
+	}
+	m_loading_untitled = nullptr;
+	m_loading_slots.clear();
+
+	// Inform user about unopened and read-only files
+	if (!m_loading_missing.isEmpty()) {
+		m_documents->alerts()->addAlert(new Alert(Alert::Warning, tr("Some files could not be opened."), m_loading_missing, true));
+	}
+	if (!m_loading_readonly.isEmpty()) {
+		m_documents->alerts()->addAlert(new Alert(Alert::Information, tr("Some files were opened Read-Only."), m_loading_readonly, true));
+	}
+	m_loading_missing.clear();
+	m_loading_errors.clear();
+	m_loading_readonly.clear();
+	m_loading = false;
+
+	// Open any files queued during load
+	if (!m_queued_documents.isEmpty()) {
+		const QStringList queued = m_queued_documents;
+		m_queued_documents.clear();
+		addDocuments(queued, queued);
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void Window::waitForLoads()
+{
+	while (m_loading && !m_loading_attaching) {
+		while (!m_loading_files.isEmpty()) {
+			attachDocument(m_loading_files.takeFirst(), false);
+		}
+		finishLoading();
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+QString Window::chooseFile(const QString& file, const QString& datafile)
+{
+	if (file.isEmpty() || (datafile == file)) {
+		return datafile;
+	}
+
+	// Prefer cached copy if it is newer
+	if (QFileInfo(datafile).lastModified() > QFileInfo(file).lastModified()) {
+		return datafile;
+	}
+
+	QMessageBox mbox(window());
+	mbox.setWindowTitle(tr("Warning"));
+	mbox.setText(tr("'%1' is newer than the cached copy.").arg(file));
+	mbox.setInformativeText(tr("Overwrite newer file?"));
+	mbox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+	mbox.setDefaultButton(QMessageBox::No);
+	mbox.setIcon(QMessageBox::Warning);
+	return (mbox.exec() == QMessageBox::Yes) ? datafile : file;
+}
+
+//-----------------------------------------------------------------------------
+
+Window::PreloadedFile Window::preloadFile(const QString& file, const QString& datafile, const QString& path) const
+{
+	PreloadedFile preload;
+	preload.path = path;
+	if (!path.isEmpty()) {
+		preload.reader = DocumentReader::start(path, Document::blockFormat(m_documents->theme()));
+	}
+	if (datafile != file) {
+		preload.unchanged = QtConcurrent::run(compareFiles, file, datafile);
+	}
+	return preload;
+}
+
+//-----------------------------------------------------------------------------
+
 void Window::closeDocument(int index, bool allow_empty)
 {
 	m_document_cache->remove(m_documents->document(index));
@@ -1106,7 +1361,7 @@ void Window::queueDocuments(const QStringList& files)
 
 //-----------------------------------------------------------------------------
 
-bool Window::saveDocument(int index)
+bool Window::saveDocument(int index, bool background)
 {
 	Document* document = m_documents->document(index);
 	if (!document->isModified()) {
@@ -1123,6 +1378,10 @@ bool Window::saveDocument(int index)
 	mbox.setIcon(QMessageBox::Warning);
 	switch (mbox.exec()) {
 	case QMessageBox::Save:
+		if (background && !document->filename().isEmpty()) {
+			document->startSave();
+			return true;
+		}
 		return document->save();
 	case QMessageBox::Discard:
 		document->setModified(false);
@@ -1136,6 +1395,40 @@ bool Window::saveDocument(int index)
 
 //-----------------------------------------------------------------------------
 
+bool Window::waitForSaves(const QList<Document*>& documents)
+{
+	int remaining = 0;
+	bool saved = true;
+	QEventLoop loop;
+	for (Document* document : documents) {
+		if (!document->isSaving()) {
+			continue;
+		}
+		++remaining;
+
+		// Errors are reported by each document
+		connect(document, &Document::saveFinished, &loop, [&](bool success) {
+			saved &= success;
+			--remaining;
+			m_load_screen->setText(tr("Saving files (%1 of %2)").arg(documents.count() - remaining).arg(documents.count()));
+			if (!remaining) {
+				loop.quit();
+			}
+		});
+	}
+
+	// Show progress while files are written
+	if (remaining) {
+		m_load_screen->setText(tr("Saving files (%1 of %2)").arg(documents.count() - remaining).arg(documents.count()));
+		loop.exec(QEventLoop::ExcludeUserInputEvents);
+		m_load_screen->finish();
+	}
+
+	return saved;
+}
+
+//-----------------------------------------------------------------------------
+
 void Window::loadPreferences()
 {
 #ifndef __OS2__
@@ -1200,6 +1493,7 @@ void Window::loadPreferences()
 		m_documents->document(i)->loadPreferences();
 	}
 	if (m_documents->count() > 0) {
+		m_documents->releaseDocuments();
 		updateDetails();
 	}
 
@@ -1,5 +1,5 @@
 /*
-	SPDX-FileCopyrightText: 2008-2017 Graeme Gott <graeme@gottcode.org>
+	SPDX-FileCopyrightText: 2008-2026 Graeme Gott <graeme@gottcode.org>
 
 	SPDX-License-Identifier: GPL-3.0-or-later
 */
@@ -12,6 +12,7 @@ class DailyProgressDialog;
 class DailyProgressLabel;
 class Document;
 class DocumentCache;
+class DocumentReader;
 class DocumentWatcher;
 class LoadScreen;
 class SessionManager;
@@ -19,8 +20,11 @@ class Sound;
 class Stack;
 class TimerManager;
 
+#include <QFuture>
 #include <QHash>
 #include <QMainWindow>
+#include <QPointer>
+#include <QSharedPointer>
 class QAction;
 class QActionGroup;
 class QLabel;
@@ -59,6 +63,7 @@ private Q_SLOTS:
 	void saveAllDocuments();
 	void closeDocument();
 	void closeDocument(const Document* document);
+	void cacheFailed(const Document* document);
 	void showDocument(const Document* document);
 	void nextDocument();
 	void previousDocument();
@@ -81,12 +86,35 @@ private Q_SLOTS:
 	void updateFormatActions();
 	void updateFormatAlignmentActions();
 	void updateSave();
+	void attachLoadedDocuments();
 
 private:
-	bool addDocument(const QString& file = QString(), const QString& datafile = QString(), int position = -1);
+	struct PreloadedFile
+	{
+		QString path;
+		QSharedPointer<DocumentReader> reader;
+		QFuture<bool> unchanged;
+	};
+
+	struct LoadingFile
+	{
+		int slot;
+		QString file;
+		QString datafile;
+		int position;
+		PreloadedFile preload;
+	};
+
+	bool addDocument(const QString& file = QString(), const QString& datafile = QString(), int position = -1, const PreloadedFile& preload = PreloadedFile());
+	void attachDocument(const LoadingFile& loading, bool show);
+	void finishLoading();
+	void waitForLoads();
+	QString chooseFile(const QString& file, const QString& datafile);
+	PreloadedFile preloadFile(const QString& file, const QString& datafile, const QString& path) const;
 	void closeDocument(int index, bool allow_empty = false);
 	void queueDocuments(const QStringList& files);
-	bool saveDocument(int index);
+	bool saveDocument(int index, bool background = false);
+	bool waitForSaves(const QList<Document*>& documents);
 	void loadPreferences();
 	void hideInterface();
 	void updateMargin();
@@ -111,6 +139,14 @@ private:
 
 	LoadScreen* m_load_screen;
 	bool m_loading;
+	int m_loading_attaching;
+	int m_loading_count;
+	QList<LoadingFile> m_loading_files;
+	QList<QPointer<Document>> m_loading_slots;
+	QPointer<Document> m_loading_untitled;
+	QStringList m_loading_missing;
+	QStringList m_loading_errors;
+	QStringList m_loading_readonly;
 
 	QTabBar* m_tabs;
 	SessionManager* m_sessions;
@@ -126,6 +162,7 @@ private:
 	DailyProgressLabel* m_progress_label;
 	QLabel* m_clock_label;
 	QTimer* m_clock_timer;
+	QTimer* m_cache_timer;
 	QTimer* m_save_timer;
 
 	bool m_fullscreen;
@@ -0,0 +1,113 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "word_index.h"
+
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+
+WordIndex::WordIndex(QObject* parent)
+	: QObject(parent)
+{
+}
+
+//-----------------------------------------------------------------------------
+
+QSet<const BlockStats*> WordIndex::blocks(const QStringList& words) const
+{
+	if (words.isEmpty()) {
+		return QSet<const BlockStats*>();
+	}
+
+	// Start with the rarest word so that intersections stay small
+	const QSet<const BlockStats*>* smallest = nullptr;
+	for (const QString& word : words) {
+		const auto i = m_blocks.constFind(word);
+		if (i == m_blocks.constEnd()) {
+			return QSet<const BlockStats*>();
+		}
+		if (!smallest || (i->size() < smallest->size())) {
+			smallest = &i.value();
+		}
+	}
+
+	QSet<const BlockStats*> result = *smallest;
+	for (const QString& word : words) {
+		const QSet<const BlockStats*>& blocks = m_blocks.constFind(word).value();
+		if (&blocks != smallest) {
+			result.intersect(blocks);
+		}
+	}
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+void WordIndex::removeBlock(const BlockStats* block)
+{
+	const QStringList words = m_words.take(block);
+	for (const QString& word : words) {
+		auto i = m_blocks.find(word);
+		if (i != m_blocks.end()) {
+			i->remove(block);
+			if (i->isEmpty()) {
+				m_blocks.erase(i);
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+
+void WordIndex::updateBlock(const BlockStats* block, QStringView text)
+{
+	QStringList words = WordIndex::words(text);
+	std::sort(words.begin(), words.end());
+	words.erase(std::unique(words.begin(), words.end()), words.end());
+
+	// Only change entries of words that were added or removed
+	QStringList& old_words = m_words[block];
+	for (const QString& word : std::as_const(old_words)) {
+		if (!std::binary_search(words.cbegin(), words.cend(), word)) {
+			auto i = m_blocks.find(word);
+			if (i != m_blocks.end()) {
+				i->remove(block);
+				if (i->isEmpty()) {
+					m_blocks.erase(i);
+				}
+			}
+		}
+	}
+	for (const QString& word : std::as_const(words)) {
+		if (!std::binary_search(old_words.cbegin(), old_words.cend(), word)) {
+			m_blocks[word].insert(block);
+		}
+	}
+	old_words = words;
+}
+
+//-----------------------------------------------------------------------------
+
+QStringList WordIndex::words(QStringView text)
+{
+	// Split at the same boundaries that whole word searches use, ignoring case
+	QStringList result;
+	qsizetype start = -1;
+	for (qsizetype i = 0, length = text.length(); i <= length; ++i) {
+		if ((i < length) && text.at(i).isLetterOrNumber()) {
+			if (start == -1) {
+				start = i;
+			}
+		} else if (start != -1) {
+			result.append(text.sliced(start, i - start).toCaseFolded());
+			start = -1;
+		}
+	}
+	return result;
+}
+
+//-----------------------------------------------------------------------------
@@ -0,0 +1,35 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef FOCUSWRITER_WORD_INDEX_H
+#define FOCUSWRITER_WORD_INDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QStringView>
+class BlockStats;
+
+// Maps words to the blocks that contain them; kept up to date by the blocks as they change
+class WordIndex : public QObject
+{
+public:
+	explicit WordIndex(QObject* parent = nullptr);
+
+	QSet<const BlockStats*> blocks(const QStringList& words) const;
+
+	void removeBlock(const BlockStats* block);
+	void updateBlock(const BlockStats* block, QStringView text);
+
+	static QStringList words(QStringView text);
+
+private:
+	QHash<QString, QSet<const BlockStats*>> m_blocks;
+	QHash<const BlockStats*, QStringList> m_words;
+};
+
+#endif // FOCUSWRITER_WORD_INDEX_H
@@ -0,0 +1,216 @@
+/*
+	SPDX-FileCopyrightText: 2026 Graeme Gott <graeme@gottcode.org>
+
+	SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "block_counts.h"
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+// Counting of BlockStats::update() before it was vectorized
+BlockCounts countBlockReference(QStringView text)
+{
+	BlockCounts counts;
+	bool word = false;
+	for (const QChar& c : text) {
+		if (c.isLetterOrNumber()) {
+			if (word == false) {
+				word = true;
+				counts.words++;
+			}
+			counts.letters += (c.category() != QChar::Punctuation_Dash);
+		} else if (c.isSpace()) {
+			word = false;
+			counts.spaces++;
+		} else if (c != u'’' && c != '\'' && c != '-') {
+			word = false;
+		}
+	}
+	return counts;
+}
+
+//-----------------------------------------------------------------------------
+
+bool compare(QStringView text)
+{
+	const BlockCounts expected = countBlockReference(text);
+	const BlockCounts actual = countBlock(text);
+	if ((actual.letters == expected.letters) && (actual.spaces == expected.spaces) && (actual.words == expected.words)) {
+		return true;
+	}
+
+	std::fprintf(stderr, "Mismatch for \"%s\": expected %d letters, %d spaces, %d words; counted %d letters, %d spaces, %d words\n",
+			qPrintable(text.toString()),
+			expected.letters, expected.spaces, expected.words,
+			actual.letters, actual.spaces, actual.words);
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+
+// Check every starting offset and length so that each chunk boundary and tail is covered
+bool compareSlices(const QString& text)
+{
+	bool result = true;
+	const qsizetype length = text.length();
+	for (qsizetype start = 0; start < qMin(length, qsizetype(33)); ++start) {
+		for (qsizetype end = start; end <= length; ++end) {
+			result &= compare(QStringView(text).sliced(start, end - start));
+		}
+	}
+	return result;
+}
+
+//-----------------------------------------------------------------------------
+
+// Pieces of text that random blocks are built from
+const QList<QString> f_ascii_pieces{
+	"a", "e", "t", "Z", "0", "7", "word", "Writing", "2026",
+	" ", " ", " ", "\t", "\n", "\r", "\v", "\f",
+	"'", "-", ".", ",", "!", "?", "\"", "(", "_", "@", "`", "{", "~", "\x7f", QString(QChar(0x1))
+};
+
+const QList<QString> f_other_pieces{
+	// Latin-1
+	"é", "ß", "Ö", "ÿ", "ª", "º", "²", "¼", "µ", "×", "÷", "«", "»", "¿",
+	QString(QChar(0xad)), QString(QChar(0x85)), QString(QChar(QChar::Nbsp)),
+	// Joiners and dashes outside Latin-1
+	"’", "‘", "‐", "—",
+	// Other scripts
+	"中", "文字", "カ", "한", "Ж", "ω", "א", "ع", "٣", "ह",
+	// Combining marks and zero width joiners
+	QString(QChar(0x301)), QString(QChar(0x308)), QString(QChar(0x200d)), QString(QChar(0x200c)),
+	// Spaces outside Latin-1
+	QString(QChar(0x2028)), QString(QChar(0x2029)), QString(QChar(0x3000)), QString(QChar(0x2009)),
+	// Surrogate pairs and unpaired surrogates
+	QString::fromUcs4(U"😀"), QString::fromUcs4(U"𝐀"), QString::fromUcs4(U"𠀀"),
+	QString(QChar(0xd800)), QString(QChar(0xdc00))
+};
+
+//-----------------------------------------------------------------------------
+
+// Build block mostly out of ASCII so that vector paths run, with other characters mixed in
+QString randomBlock(std::mt19937& random, int pieces)
+{
+	std::uniform_int_distribution<qsizetype> ascii(0, f_ascii_pieces.count() - 1);
+	std::uniform_int_distribution<qsizetype> other(0, f_other_pieces.count() - 1);
+	std::uniform_int_distribution<int> run(0, 40);
+	std::uniform_int_distribution<int> kind(0, 3);
+
+	QString text;
+	for (int i = 0; i < pieces; ++i) {
+		switch (kind(random)) {
+		case 0:
+			text += f_other_pieces.at(other(random));
+			break;
+		case 1:
+			for (int j = 0, count = run(random); j < count; ++j) {
+				text += f_ascii_pieces.at(ascii(random));
+			}
+			break;
+		default:
+			text += f_ascii_pieces.at(ascii(random));
+			break;
+		}
+	}
+	return text;
+}
+
+//-----------------------------------------------------------------------------
+
+int benchmark()
+{
+	std::mt19937 random(2026);
+	QString text;
+	while (text.length() < 0x100000) {
+		text += QString("It's a well-known fact that writers write; ").repeated(20);
+		text += randomBlock(random, 40);
+	}
+
+	const int iterations = 50;
+	QElapsedTimer timer;
+	int total = 0;
+
+	timer.start();
+	for (int i = 0; i < iterations; ++i) {
+		total += countBlockReference(text).words;
+	}
+	const qint64 reference = timer.nsecsElapsed();
+
+	timer.restart();
+	for (int i = 0; i < iterations; ++i) {
+		total -= countBlock(text).words;
+	}
+	const qint64 vectorized = timer.nsecsElapsed();
+
+	std::printf("Per-character: %.2f ms per MiB\n", reference / (iterations * 1e6));
+	std::printf("Vectorized: %.2f ms per MiB\n", vectorized / (iterations * 1e6));
+	return (total == 0) ? 0 : 1;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+#if defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+	if (!__builtin_cpu_supports("avx2")) {
+		std::printf("Skipped, processor does not support AVX2\n");
+		return 77;
+	}
+#endif
+
+	if ((argc > 1) && (std::strcmp(argv[1], "--benchmark") == 0)) {
+		return benchmark();
+	}
+
+	bool result = true;
+
+	// Fixed samples
+	const QList<QString> samples{
+		QString(),
+		"a",
+		"Hello, world!",
+		"It's a well-known fact that 2 + 2 = 4.\tTabs\tand\nnewlines too",
+		"'leading and trailing' - -- --- ' ' word-'-word",
+		"Ünïcödé wörds ánd «quotes» with ½ and ² and ª",
+		"日本語の文章と English words mixed 一緒に",
+		"Combining e" + QString(QChar(0x301)) + " and zero" + QChar(0x200d) + "width" + QChar(0x200c) + "joiners",
+		"Emoji " + QString::fromUcs4(U"😀") + " and math " + QString::fromUcs4(U"𝐀𝐁") + " and lone " + QChar(0xd800) + "surrogates" + QChar(0xdc00),
+		QString("abcdefghijklmnop").repeated(9) + "’s",
+		QString("word ").repeated(13) + "x'" + QString("-").repeated(20) + "y"
+	};
+	for (const QString& sample : samples) {
+		result &= compareSlices(sample);
+	}
+
+	// Random blocks
+	std::mt19937 random(1);
+	std::uniform_int_distribution<int> pieces(0, 60);
+	for (int i = 0; i < 2000; ++i) {
+		const QString text = randomBlock(random, pieces(random));
+		result &= compare(text);
+		if (i < 100) {
+			result &= compareSlices(text);
+		}
+	}
+
+	if (!result) {
+		return 1;
+	}
+	std::printf("Counts match\n");
+	return 0;
+}